@@ -0,0 +1,362 @@
+#include <stdlib.h>
+#include <string.h>
+#include "archive.h"
+
+static void putLittleEndian(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittleEndian(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+int archiveWriteHeader(FILE* file, uint64_t entry_count, int flags) {
+    unsigned char header[ARCHIVE_HEADER_SIZE] = {0};
+    memcpy(header, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE);
+    putLittleEndian(header + 8, ARCHIVE_VERSION, 2);
+    putLittleEndian(header + 10, (uint64_t)flags, 2);
+    putLittleEndian(header + 16, entry_count, 8);
+    return (fwrite(header, 1, sizeof(header), file) == sizeof(header)) ? 0 : -1;
+}
+
+int archiveReadHeader(FILE* file, ArchiveHeader* header) {
+    unsigned char data[ARCHIVE_HEADER_SIZE];
+    if (fread(data, 1, sizeof(data), file) != sizeof(data) ||
+        memcmp(data, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE) != 0) {
+        return -1;
+    }
+    header->version = (int)getLittleEndian(data + 8, 2);
+    header->flags = (int)getLittleEndian(data + 10, 2);
+    header->entry_count = getLittleEndian(data + 16, 8);
+    return 0;
+}
+
+int archiveWriteEntry(FILE* file, const ArchiveEntry* entry, const char* path) {
+    unsigned char data[ARCHIVE_ENTRY_SIZE] = {0};
+    data[0] = (unsigned char)entry->type;
+    data[1] = (unsigned char)entry->encoding;
+    putLittleEndian(data + 2, (uint64_t)entry->flags, 2);
+    putLittleEndian(data + 4, entry->path_length, 4);
+    putLittleEndian(data + 8, entry->size, 8);
+    putLittleEndian(data + 16, entry->payload_length, 8);
+    if (fwrite(data, 1, sizeof(data), file) != sizeof(data) ||
+        fwrite(path, 1, entry->path_length, file) != entry->path_length) {
+        return -1;
+    }
+    return 0;
+}
+
+int archiveReadEntry(FILE* file, off_t archive_size, ArchiveEntry* entry, char** path) {
+    unsigned char data[ARCHIVE_ENTRY_SIZE];
+    off_t offset = ftello(file);
+    if (offset < 0 || fread(data, 1, sizeof(data), file) != sizeof(data)) {
+        return -1;
+    }
+    entry->type = data[0];
+    entry->encoding = data[1];
+    entry->flags = (int)getLittleEndian(data + 2, 2);
+    entry->path_length = (uint32_t)getLittleEndian(data + 4, 4);
+    entry->size = getLittleEndian(data + 8, 8);
+    entry->payload_length = getLittleEndian(data + 16, 8);
+    entry->payload_offset = offset + ARCHIVE_ENTRY_SIZE + (off_t)entry->path_length;
+
+    // Chemin et code doivent tenir dans l'archive : une longueur corrompue ne
+    // provoque ni grande allocation ni lecture au-delà de la fin
+    if (entry->type > ARCHIVE_DIRECTORY || (entry->type == ARCHIVE_FILE && entry->path_length == 0) ||
+        (entry->flags & ~(ARCHIVE_ENTRY_CHUNKED | ARCHIVE_ENTRY_LINK)) != 0 || entry->payload_offset > archive_size ||
+        entry->payload_length > (uint64_t)(archive_size - entry->payload_offset) ||
+        entry->size > SIZE_MAX) {
+        return -1;
+    }
+
+    char* name = (char*)malloc((size_t)entry->path_length + 1);
+    if (!name) {
+        return -1;
+    }
+    if (fread(name, 1, entry->path_length, file) != entry->path_length ||
+        memchr(name, '\0', entry->path_length) != NULL) {
+        free(name);
+        return -1;
+    }
+    name[entry->path_length] = '\0';
+    *path = name;
+    return 0;
+}
+
+int archivePatchPayload(FILE* file, off_t entry_offset, uint64_t payload_length) {
+    unsigned char data[8];
+    putLittleEndian(data, payload_length, 8);
+    if (fseeko(file, entry_offset + 16, SEEK_SET) != 0 ||
+        fwrite(data, 1, sizeof(data), file) != sizeof(data) ||
+        fseeko(file, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int archiveWriteChunk(FILE* file, const ArchiveChunk* chunk) {
+    unsigned char data[ARCHIVE_CHUNK_SIZE] = {0};
+    data[0] = (unsigned char)chunk->kind;
+    putLittleEndian(data + 4, chunk->size, 4);
+    putLittleEndian(data + 8, chunk->code_length, 8);
+    putLittleEndian(data + 16, (uint64_t)chunk->code_offset, 8);
+    return (fwrite(data, 1, sizeof(data), file) == sizeof(data)) ? 0 : -1;
+}
+
+int archivePatchChunk(FILE* file, off_t chunk_offset, uint64_t code_length) {
+    unsigned char data[8];
+    putLittleEndian(data, code_length, 8);
+    if (fseeko(file, chunk_offset + 8, SEEK_SET) != 0 ||
+        fwrite(data, 1, sizeof(data), file) != sizeof(data) ||
+        fseeko(file, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int archiveParseChunk(const unsigned char* data, ArchiveChunk* chunk) {
+    chunk->kind = data[0];
+    chunk->size = (uint32_t)getLittleEndian(data + 4, 4);
+    chunk->code_length = getLittleEndian(data + 8, 8);
+    chunk->code_offset = (off_t)getLittleEndian(data + 16, 8);
+    // Un morceau produit au moins un octet : un code vide n'est jamais référencé
+    if (chunk->kind > ARCHIVE_CHUNK_REFERENCE || chunk->size == 0 ||
+        getLittleEndian(data + 16, 8) > (uint64_t)INT64_MAX) {
+        return -1;
+    }
+    return 0;
+}
+
+int archiveWriteLink(FILE* file, const ArchiveLink* link) {
+    unsigned char data[ARCHIVE_LINK_SIZE] = {0};
+    data[0] = (unsigned char)link->kind;
+    putLittleEndian(data + 2, (uint64_t)link->flags, 2);
+    putLittleEndian(data + 8, link->target, 8);
+    putLittleEndian(data + 16, (uint64_t)link->code_offset, 8);
+    putLittleEndian(data + 24, link->code_length, 8);
+    return (fwrite(data, 1, sizeof(data), file) == sizeof(data)) ? 0 : -1;
+}
+
+int archiveReadLink(FILE* file, const ArchiveEntry* entry, ArchiveLink* link) {
+    unsigned char data[ARCHIVE_LINK_SIZE];
+    if (entry->payload_length != ARCHIVE_LINK_SIZE ||
+        fseeko(file, entry->payload_offset, SEEK_SET) != 0 ||
+        fread(data, 1, sizeof(data), file) != sizeof(data)) {
+        return -1;
+    }
+    link->kind = data[0];
+    link->flags = (int)getLittleEndian(data + 2, 2);
+    link->target = getLittleEndian(data + 8, 8);
+    link->code_length = getLittleEndian(data + 24, 8);
+
+    // Le code de l'original est écrit avant l'entrée qui y renvoie
+    uint64_t code_offset = getLittleEndian(data + 16, 8);
+    if (link->kind > ARCHIVE_LINK_COPY || (link->flags & ~ARCHIVE_ENTRY_CHUNKED) != 0 ||
+        code_offset < ARCHIVE_HEADER_SIZE + ARCHIVE_ENTRY_SIZE || code_offset > (uint64_t)entry->payload_offset ||
+        link->code_length > (uint64_t)entry->payload_offset - code_offset) {
+        return -1;
+    }
+    link->code_offset = (off_t)code_offset;
+    return 0;
+}
+
+// Chemin d'une entrée et son numéro, triés pour l'index de la table des matières
+typedef struct {
+    const char* path;
+    uint64_t number;
+} TocName;
+
+static int compareNames(const void* a, const void* b) {
+    const TocName* x = (const TocName*)a;
+    const TocName* y = (const TocName*)b;
+    int order = strcmp(x->path, y->path);
+    if (order != 0) {
+        return order;
+    }
+    return (x->number > y->number) - (x->number < y->number);
+}
+
+int archiveWriteToc(FILE* file, const ArchiveEntry* entries, const char* const* paths, size_t count) {
+    off_t toc_offset = ftello(file);
+    TocName* names = (TocName*)malloc((count ? count : 1) * sizeof(TocName));
+    if (toc_offset < 0 || !names) {
+        free(names);
+        return -1;
+    }
+
+    unsigned char data[ARCHIVE_RECORD_SIZE];
+    uint64_t pool_length = 0;
+    int status = 0;
+    for (size_t i = 0; i < count && status == 0; i++) {
+        memset(data, 0, sizeof(data));
+        data[0] = (unsigned char)entries[i].type;
+        data[1] = (unsigned char)entries[i].encoding;
+        putLittleEndian(data + 2, (uint64_t)entries[i].flags, 2);
+        putLittleEndian(data + 4, entries[i].path_length, 4);
+        putLittleEndian(data + 8, entries[i].size, 8);
+        putLittleEndian(data + 16, (uint64_t)entries[i].payload_offset, 8);
+        putLittleEndian(data + 24, entries[i].payload_length, 8);
+        putLittleEndian(data + 32, pool_length, 8);
+        if (fwrite(data, 1, ARCHIVE_RECORD_SIZE, file) != ARCHIVE_RECORD_SIZE) {
+            status = -1;
+        }
+        pool_length += entries[i].path_length;
+        names[i].path = paths[i];
+        names[i].number = i;
+    }
+
+    // Ordre des octets (strcmp) : celui de la recherche dans archiveLookup
+    qsort(names, count, sizeof(TocName), compareNames);
+    for (size_t i = 0; i < count && status == 0; i++) {
+        putLittleEndian(data, names[i].number, 8);
+        if (fwrite(data, 1, 8, file) != 8) {
+            status = -1;
+        }
+    }
+    free(names);
+
+    for (size_t i = 0; i < count && status == 0; i++) {
+        if (fwrite(paths[i], 1, entries[i].path_length, file) != entries[i].path_length) {
+            status = -1;
+        }
+    }
+
+    putLittleEndian(data, (uint64_t)toc_offset, 8);
+    putLittleEndian(data + 8, count, 8);
+    putLittleEndian(data + 16, pool_length, 8);
+    memcpy(data + 24, ARCHIVE_TOC_MAGIC, 8);
+    if (status == 0 && fwrite(data, 1, ARCHIVE_FOOTER_SIZE, file) != ARCHIVE_FOOTER_SIZE) {
+        status = -1;
+    }
+    return status;
+}
+
+int archiveReadToc(FILE* file, off_t archive_size, const ArchiveHeader* header, ArchiveToc* toc) {
+    unsigned char data[ARCHIVE_FOOTER_SIZE];
+    if (!(header->flags & ARCHIVE_FLAG_TOC) || archive_size < ARCHIVE_HEADER_SIZE + ARCHIVE_FOOTER_SIZE ||
+        fseeko(file, archive_size - ARCHIVE_FOOTER_SIZE, SEEK_SET) != 0 ||
+        fread(data, 1, sizeof(data), file) != sizeof(data) ||
+        memcmp(data + 24, ARCHIVE_TOC_MAGIC, 8) != 0) {
+        return -1;
+    }
+    uint64_t toc_offset = getLittleEndian(data, 8);
+    toc->entry_count = getLittleEndian(data + 8, 8);
+    toc->pool_length = getLittleEndian(data + 16, 8);
+
+    // Enregistrements, index et chemins remplissent exactement l'espace avant le pied
+    uint64_t end = (uint64_t)(archive_size - ARCHIVE_FOOTER_SIZE);
+    if (toc->entry_count != header->entry_count || toc_offset < ARCHIVE_HEADER_SIZE || toc_offset > end) {
+        return -1;
+    }
+    uint64_t space = end - toc_offset;
+    if (toc->entry_count > space / (ARCHIVE_RECORD_SIZE + 8) ||
+        toc->pool_length != space - toc->entry_count * (ARCHIVE_RECORD_SIZE + 8)) {
+        return -1;
+    }
+    toc->offset = (off_t)toc_offset;
+    return 0;
+}
+
+// Enregistrement number de la table ; path_offset : position de son chemin
+// parmi les chemins
+static int readRecord(FILE* file, const ArchiveToc* toc, uint64_t number, ArchiveEntry* entry, uint64_t* path_offset) {
+    unsigned char data[ARCHIVE_RECORD_SIZE];
+    if (number >= toc->entry_count ||
+        fseeko(file, toc->offset + (off_t)(number * ARCHIVE_RECORD_SIZE), SEEK_SET) != 0 ||
+        fread(data, 1, sizeof(data), file) != sizeof(data)) {
+        return -1;
+    }
+    entry->type = data[0];
+    entry->encoding = data[1];
+    entry->flags = (int)getLittleEndian(data + 2, 2);
+    entry->path_length = (uint32_t)getLittleEndian(data + 4, 4);
+    entry->size = getLittleEndian(data + 8, 8);
+    entry->payload_offset = (off_t)getLittleEndian(data + 16, 8);
+    entry->payload_length = getLittleEndian(data + 24, 8);
+    *path_offset = getLittleEndian(data + 32, 8);
+
+    // Le code doit se trouver entre l'en-tête et la table
+    uint64_t payload_offset = getLittleEndian(data + 16, 8);
+    if (entry->type > ARCHIVE_DIRECTORY || entry->size > SIZE_MAX || (entry->flags & ~(ARCHIVE_ENTRY_CHUNKED | ARCHIVE_ENTRY_LINK)) != 0 ||
+        *path_offset > toc->pool_length || entry->path_length > toc->pool_length - *path_offset ||
+        payload_offset < ARCHIVE_HEADER_SIZE + ARCHIVE_ENTRY_SIZE || payload_offset > (uint64_t)toc->offset ||
+        entry->payload_length > (uint64_t)toc->offset - payload_offset) {
+        return -1;
+    }
+    return 0;
+}
+
+// Compare le chemin enregistré à path dans l'ordre de strcmp, par morceaux
+static int comparePath(FILE* file, const ArchiveToc* toc, uint64_t path_offset, uint32_t path_length,
+                       const char* path, int* order) {
+    off_t pool = toc->offset + (off_t)(toc->entry_count * (ARCHIVE_RECORD_SIZE + 8));
+    if (fseeko(file, pool + (off_t)path_offset, SEEK_SET) != 0) {
+        return -1;
+    }
+    size_t target_length = strlen(path);
+    unsigned char piece[256];
+    size_t done = 0;
+    while (done < path_length) {
+        size_t length = path_length - done;
+        if (length > sizeof(piece)) {
+            length = sizeof(piece);
+        }
+        if (fread(piece, 1, length, file) != length) {
+            return -1;
+        }
+        size_t common = (target_length - done < length) ? target_length - done : length;
+        int difference = memcmp(piece, path + done, common);
+        if (difference != 0 || common < length) {
+            *order = (difference != 0) ? difference : 1;
+            return 0;
+        }
+        done += length;
+    }
+    *order = (done < target_length) ? -1 : 0;
+    return 0;
+}
+
+// Lit l'entrée à la position position de l'index trié et la compare à path
+static int probeIndex(FILE* file, const ArchiveToc* toc, uint64_t position, const char* path,
+                      ArchiveEntry* entry, int* order) {
+    off_t index = toc->offset + (off_t)(toc->entry_count * ARCHIVE_RECORD_SIZE);
+    unsigned char data[8];
+    uint64_t path_offset;
+    if (fseeko(file, index + (off_t)(position * 8), SEEK_SET) != 0 ||
+        fread(data, 1, sizeof(data), file) != sizeof(data) ||
+        readRecord(file, toc, getLittleEndian(data, 8), entry, &path_offset) != 0) {
+        return -1;
+    }
+    return comparePath(file, toc, path_offset, entry->path_length, path, order);
+}
+
+int archiveLookup(FILE* file, const ArchiveToc* toc, const char* path, ArchiveEntry* entry) {
+    // Première position de l'index dont le chemin n'est pas inférieur à path
+    uint64_t low = 0;
+    uint64_t high = toc->entry_count;
+    int order;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (probeIndex(file, toc, middle, path, entry, &order) != 0) {
+            return -1;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == toc->entry_count) {
+        return 0;
+    }
+    if (probeIndex(file, toc, low, path, entry, &order) != 0) {
+        return -1;
+    }
+    return (order == 0) ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Format binaire des archives (version 2), entiers en petit-boutiste :
+//   en-tête : magic (8 octets), version (u16), flags (u16), réservé (u32), entry_count (u64)
+//   entrée  : type (u8), encoding (u8), flags (u16), path_length (u32), size (u64),
+//             payload_length (u64), puis path_length octets de chemin et le code
+// La longueur de chaque entrée est connue : l'entrée suivante est atteinte par
+// un seul déplacement, sans lire le code ni chercher de fin de ligne.
+//
+// Avec ARCHIVE_ENTRY_CHUNKED, le code de l'entrée est une suite de morceaux,
+// chacun encodé depuis une bande vierge ; leurs sorties mises bout à bout
+// redonnent le fichier :
+//   morceau : kind (u8), réservé (3 octets), size (u32), code_length (u64), code_offset (u64)
+//   ARCHIVE_CHUNK_CODE      : les code_length octets de code suivent (code_offset vaut 0)
+//   ARCHIVE_CHUNK_REFERENCE : code d'un morceau identique écrit plus tôt dans
+//                             l'archive, code_length octets à code_offset
+//
+// Avec ARCHIVE_ENTRY_LINK, le fichier est le double d'une entrée précédente
+// (target) ; son code est remplacé par un lien vers celui de l'original :
+//   lien : kind (u8), réservé (u8), flags (u16) du code, réservé (u32), target (u64),
+//          code_offset (u64), code_length (u64)
+// L'extraction recrée le double à partir de l'original déjà extrait, sinon
+// décode ce code (encodage de l'entrée, flags du lien).
+//
+// Avec ARCHIVE_FLAG_TOC, une table des matières suit la dernière entrée :
+//   enregistrements : type (u8), encoding (u8), flags (u16), path_length (u32), size (u64),
+//                     payload_offset (u64), payload_length (u64), path_offset (u64)
+//   index           : numéros d'enregistrement (u64) triés par chemin
+//   chemins         : chemins bout à bout, sans terminateur
+//   pied            : toc_offset (u64), entry_count (u64), pool_length (u64), magic (8 octets)
+// Le pied, à la fin du fichier, donne accès à n'importe quelle entrée par
+// recherche dichotomique sans parcourir les précédentes.
+#define ARCHIVE_MAGIC "\x89" "BFZ\r\n\x1a\n"
+#define ARCHIVE_MAGIC_SIZE 8
+#define ARCHIVE_VERSION 2
+#define ARCHIVE_HEADER_SIZE 24
+#define ARCHIVE_ENTRY_SIZE 24
+#define ARCHIVE_FLAG_TOC 1
+#define ARCHIVE_TOC_MAGIC "BFZ-TOC\n"
+#define ARCHIVE_RECORD_SIZE 40
+#define ARCHIVE_FOOTER_SIZE 32
+#define ARCHIVE_CHUNK_SIZE 24
+#define ARCHIVE_LINK_SIZE 32
+
+// Options d'une entrée
+#define ARCHIVE_ENTRY_CHUNKED 1  // Code découpé en morceaux dédupliqués
+#define ARCHIVE_ENTRY_LINK 2     // Double d'un fichier précédent
+
+// Types d'entrée
+enum {
+    ARCHIVE_FILE = 0,
+    ARCHIVE_DIRECTORY
+};
+
+// Encodages du code d'une entrée
+enum {
+    ARCHIVE_PAYLOAD_BRAINFUCK = 0,  // Code Brainfuck en texte
+    ARCHIVE_PAYLOAD_PACKED,         // Code compacté en suites de commandes (bfPack)
+    ARCHIVE_PAYLOAD_HUFFMAN         // Code compacté puis codé par blocs de Huffman (huffman.h)
+};
+
+// Morceaux d'une entrée ARCHIVE_ENTRY_CHUNKED
+enum {
+    ARCHIVE_CHUNK_CODE = 0,
+    ARCHIVE_CHUNK_REFERENCE
+};
+
+// Doubles d'une entrée ARCHIVE_ENTRY_LINK
+enum {
+    ARCHIVE_LINK_HARD = 0,  // Même inode que l'original : lien physique
+    ARCHIVE_LINK_COPY       // Même contenu : copie
+};
+
+typedef struct {
+    int version;
+    int flags;
+    uint64_t entry_count;
+} ArchiveHeader;
+
+typedef struct {
+    int type;
+    int encoding;
+    int flags;                // ARCHIVE_ENTRY_*
+    uint32_t path_length;
+    uint64_t size;            // Taille du fichier extrait
+    uint64_t payload_length;  // Octets de code après le chemin
+    off_t payload_offset;     // Position du code dans l'archive (ignorée par archiveWriteEntry)
+} ArchiveEntry;
+
+typedef struct {
+    int kind;
+    uint32_t size;            // Octets produits par le code du morceau
+    uint64_t code_length;
+    off_t code_offset;        // Code d'un ARCHIVE_CHUNK_REFERENCE
+} ArchiveChunk;
+
+typedef struct {
+    int kind;
+    int flags;                // Options du code de l'original (ARCHIVE_ENTRY_CHUNKED)
+    uint64_t target;          // Numéro de l'entrée originale
+    uint64_t code_length;
+    off_t code_offset;
+} ArchiveLink;
+
+// Table des matières trouvée par archiveReadToc
+typedef struct {
+    off_t offset;          // Début des enregistrements
+    uint64_t entry_count;
+    uint64_t pool_length;  // Octets de chemins
+} ArchiveToc;
+
+// Les fonctions retournent 0, ou -1 si l'écriture échoue ou si les données
+// lues sont tronquées ou incohérentes
+int archiveWriteHeader(FILE* file, uint64_t entry_count, int flags);
+int archiveReadHeader(FILE* file, ArchiveHeader* header);
+int archiveWriteEntry(FILE* file, const ArchiveEntry* entry, const char* path);
+// Lit l'en-tête et le chemin (alloué, terminé par '\0') de l'entrée à la position
+// courante, et laisse le fichier au début de son code ; l'entrée doit tenir
+// dans les archive_size octets de l'archive
+int archiveReadEntry(FILE* file, off_t archive_size, ArchiveEntry* entry, char** path);
+// Corrige la longueur du code de l'entrée écrite à entry_offset, une fois le
+// code écrit à la suite, puis revient à la fin du fichier
+int archivePatchPayload(FILE* file, off_t entry_offset, uint64_t payload_length);
+
+// Enregistrement de morceau ; celui d'un ARCHIVE_CHUNK_CODE est corrigé par
+// archivePatchChunk une fois son code écrit à la suite
+int archiveWriteChunk(FILE* file, const ArchiveChunk* chunk);
+int archivePatchChunk(FILE* file, off_t chunk_offset, uint64_t code_length);
+// Décode les ARCHIVE_CHUNK_SIZE octets d'un enregistrement de morceau
+int archiveParseChunk(const unsigned char* data, ArchiveChunk* chunk);
+
+// Lien d'une entrée ARCHIVE_ENTRY_LINK, écrit comme son code ; le code désigné
+// doit précéder l'entrée
+int archiveWriteLink(FILE* file, const ArchiveLink* link);
+int archiveReadLink(FILE* file, const ArchiveEntry* entry, ArchiveLink* link);
+
+// Écrit la table des matières des count entrées (payload_offset renseigné)
+// et le pied de l'archive à la position courante
+int archiveWriteToc(FILE* file, const ArchiveEntry* entries, const char* const* paths, size_t count);
+// Lit le pied d'une archive de archive_size octets ; -1 sans table des matières valide
+int archiveReadToc(FILE* file, off_t archive_size, const ArchiveHeader* header, ArchiveToc* toc);
+// Cherche path dans l'index trié : 1 et l'entrée si trouvée, 0 si absente, -1 si
+// la table est incohérente
+int archiveLookup(FILE* file, const ArchiveToc* toc, const char* path, ArchiveEntry* entry);
+
+#endif //ARCHIVE_H
@@ -2,186 +2,2120 @@
 #include <stdlib.h>
 #include <string.h>
 #include "brainfuck.h"
+#include "bytecode.h"
+#include "jit.h"
 
-#define CELL_SIZE 30000
+#if !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__))
+#include <pthread.h>
+#define PARALLEL_DECODE
+#endif
+
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Au-delà de cet écart, l'algorithme glouton réinitialise la cellule avec '[-]'
+#define GREEDY_RESET_THRESHOLD 10
+
+// Longueur de l'extrait glouton menant de current à target, '.' compris
+static size_t greedyStepSize(unsigned char current, unsigned char target) {
+    int diff = target - current;
+    if (abs(diff) > GREEDY_RESET_THRESHOLD) {
+        return 3 + (size_t)target + 1;
+    }
+    return (size_t)abs(diff) + 1;
+}
+
+// Écrit l'extrait glouton menant de current à target ; retourne la nouvelle fin
+static char* greedyStep(char* out, unsigned char current, unsigned char target) {
+    int diff = target - current;
+
+    // Réinitialiser la cellule si nécessaire
+    if (abs(diff) > GREEDY_RESET_THRESHOLD) {
+        memcpy(out, "[-]", 3);
+        out += 3;
+        diff = target;
+    }
+
+    // Générer les '+' ou '-' puis '.'
+    size_t count = abs(diff);
+    memset(out, (diff > 0) ? '+' : '-', count);
+    out += count;
+    *out++ = '.';
+    return out;
+}
+
+// Noyau vectoriel de l'algorithme glouton. L'extrait de chaque octet ne
+// dépend que de l'octet précédent : les écarts, les réinitialisations et les
+// longueurs se calculent par blocs de GREEDY_VECTOR_WIDTH octets, puis chaque
+// extrait est écrit par des stores larges de '+' ou '-' (le '.' final écrase
+// le surplus). La sortie est identique octet pour octet à greedyStep.
+#if defined(__AVX512BW__)
+#define GREEDY_VECTOR_WIDTH 64
+#elif defined(__AVX2__)
+#define GREEDY_VECTOR_WIDTH 32
+#elif defined(__SSE2__)
+#define GREEDY_VECTOR_WIDTH 16
+#endif
+
+#ifdef GREEDY_VECTOR_WIDTH
+
+// Analyse un bloc dont l'octet précédent est data[-1] : nombre de '+'/'-' de
+// chaque extrait, masque des réinitialisations et masque des écarts positifs.
+// Retourne la somme des nombres de '+'/'-' du bloc.
+static size_t greedyAnalyze(const unsigned char* data, unsigned char* counts,
+                            unsigned long long* resets, unsigned long long* ups) {
+#if defined(__AVX512BW__)
+    __m512i target = _mm512_loadu_si512((const void*)data);
+    __m512i previous = _mm512_loadu_si512((const void*)(data - 1));
+    __m512i distance = _mm512_sub_epi8(_mm512_max_epu8(target, previous), _mm512_min_epu8(target, previous));
+    __mmask64 small = _mm512_cmple_epu8_mask(distance, _mm512_set1_epi8(GREEDY_RESET_THRESHOLD));
+    __m512i count = _mm512_mask_blend_epi8(small, target, distance);
+    _mm512_storeu_si512((void*)counts, count);
+    *resets = ~(unsigned long long)small;
+    *ups = (unsigned long long)_mm512_cmpge_epu8_mask(target, previous);
+    return (size_t)_mm512_reduce_add_epi64(_mm512_sad_epu8(count, _mm512_setzero_si512()));
+#elif defined(__AVX2__)
+    __m256i target = _mm256_loadu_si256((const __m256i*)data);
+    __m256i previous = _mm256_loadu_si256((const __m256i*)(data - 1));
+    __m256i high = _mm256_max_epu8(target, previous);
+    __m256i distance = _mm256_sub_epi8(high, _mm256_min_epu8(target, previous));
+    __m256i small = _mm256_cmpeq_epi8(_mm256_min_epu8(distance, _mm256_set1_epi8(GREEDY_RESET_THRESHOLD)), distance);
+    __m256i count = _mm256_blendv_epi8(target, distance, small);
+    _mm256_storeu_si256((__m256i*)counts, count);
+    *resets = ~(unsigned int)_mm256_movemask_epi8(small);
+    *ups = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, target));
+    __m256i sums = _mm256_sad_epu8(count, _mm256_setzero_si256());
+    return (size_t)(_mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1)
+                    + _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+#else
+    __m128i target = _mm_loadu_si128((const __m128i*)data);
+    __m128i previous = _mm_loadu_si128((const __m128i*)(data - 1));
+    __m128i high = _mm_max_epu8(target, previous);
+    __m128i distance = _mm_sub_epi8(high, _mm_min_epu8(target, previous));
+    __m128i small = _mm_cmpeq_epi8(_mm_min_epu8(distance, _mm_set1_epi8(GREEDY_RESET_THRESHOLD)), distance);
+    __m128i count = _mm_or_si128(_mm_and_si128(small, distance), _mm_andnot_si128(small, target));
+    _mm_storeu_si128((__m128i*)counts, count);
+    *resets = ~(unsigned int)_mm_movemask_epi8(small) & 0xFFFFu;
+    *ups = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(high, target));
+    __m128i sums = _mm_sad_epu8(count, _mm_setzero_si128());
+    return (size_t)(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+#endif
+}
+
+#endif
+
+// Taille du code glouton de data à partir de current
+static size_t greedySize(const unsigned char* data, size_t length, unsigned char current) {
+    size_t bf_size = 0;
+    size_t i = 0;
+#ifdef GREEDY_VECTOR_WIDTH
+    if (length > 0) {
+        bf_size += greedyStepSize(current, data[0]);
+        i = 1;
+    }
+    unsigned char counts[GREEDY_VECTOR_WIDTH];
+    unsigned long long resets, ups;
+    for (; i + GREEDY_VECTOR_WIDTH <= length; i += GREEDY_VECTOR_WIDTH) {
+        bf_size += greedyAnalyze(data + i, counts, &resets, &ups) + GREEDY_VECTOR_WIDTH
+                   + 3 * (size_t)__builtin_popcountll(resets);
+    }
+    if (i > 0) {
+        current = data[i - 1];
+    }
+#endif
+    for (; i < length; i++) {
+        bf_size += greedyStepSize(current, data[i]);
+        current = data[i];
+    }
+    return bf_size;
+}
+
+// Écrit le code glouton de data à partir de current ; out doit disposer de
+// BF_INTO_SLACK octets de marge au-delà de la taille exacte
+static char* greedyWrite(const unsigned char* data, size_t length, unsigned char current, char* out) {
+    size_t i = 0;
+#ifdef GREEDY_VECTOR_WIDTH
+    if (length > 0) {
+        out = greedyStep(out, current, data[0]);
+        i = 1;
+    }
+#if defined(__AVX2__)
+    const __m256i plus = _mm256_set1_epi8('+');
+    const __m256i minus = _mm256_set1_epi8('-');
+#define GREEDY_STORE_WIDTH 32
+#define GREEDY_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+    __m256i fill;
+#else
+    const __m128i plus = _mm_set1_epi8('+');
+    const __m128i minus = _mm_set1_epi8('-');
+#define GREEDY_STORE_WIDTH 16
+#define GREEDY_STORE(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+    __m128i fill;
+#endif
+    unsigned char counts[GREEDY_VECTOR_WIDTH];
+    unsigned long long resets, ups;
+    for (; i + GREEDY_VECTOR_WIDTH <= length; i += GREEDY_VECTOR_WIDTH) {
+        greedyAnalyze(data + i, counts, &resets, &ups);
+        for (int j = 0; j < GREEDY_VECTOR_WIDTH; j++) {
+            size_t count = counts[j];
+            if ((resets >> j) & 1) {
+                memcpy(out, "[-]", 3);
+                out += 3;
+                fill = plus;
+            } else {
+                fill = ((ups >> j) & 1) ? plus : minus;
+            }
+            GREEDY_STORE(out, fill);
+            for (size_t k = GREEDY_STORE_WIDTH; k < count; k += GREEDY_STORE_WIDTH) {
+                GREEDY_STORE(out + k, fill);
+            }
+            out[count] = '.';
+            out += count + 1;
+        }
+    }
+#undef GREEDY_STORE
+#undef GREEDY_STORE_WIDTH
+    if (i > 0) {
+        current = data[i - 1];
+    }
+#endif
+    for (; i < length; i++) {
+        out = greedyStep(out, current, data[i]);
+        current = data[i];
+    }
+    return out;
+}
+
+// Taille exacte (hors '\0' final) du code produit par toBrainfuck
+size_t toBrainfuckSize(const unsigned char* data, size_t length) {
+    return greedySize(data, length, 0);
+}
+
+// Écrit le code glouton dans dst (sans '\0') et retourne sa longueur, ou
+// (size_t)-1 si capacity est insuffisante. Avec BF_INTO_SLACK octets de marge
+// au-delà de la taille exacte, le noyau vectoriel est utilisé.
+size_t toBrainfuckInto(const unsigned char* data, size_t length, char* dst, size_t capacity) {
+    size_t bf_size = greedySize(data, length, 0);
+    if (bf_size > capacity) {
+        return (size_t)-1;
+    }
+    if (capacity - bf_size >= BF_INTO_SLACK) {
+        return greedyWrite(data, length, 0, dst) - dst;
+    }
+
+    char* out = dst;
+    unsigned char current_value = 0;
+    for (size_t i = 0; i < length; i++) {
+        out = greedyStep(out, current_value, data[i]);
+        current_value = data[i];
+    }
+    return out - dst;
+}
 
 char* toBrainfuck(const unsigned char* data, size_t length) {
-    size_t max_size = length * 20; // Taille estimée
-    char* bf_code = (char*)malloc(max_size * sizeof(char));
+    // Taille exacte calculée à l'avance : une seule allocation, aucune réallocation
+    size_t bf_size = toBrainfuckSize(data, length);
+    char* bf_code = (char*)malloc(bf_size + BF_INTO_SLACK);
     if (!bf_code) {
         fprintf(stderr, "Erreur d'allocation mémoire\n");
         return NULL;
     }
-    size_t bf_index = 0;
 
-    unsigned char current_value = 0;
+    toBrainfuckInto(data, length, bf_code, bf_size + BF_INTO_SLACK);
+    bf_code[bf_size] = '\0';
+
+    return bf_code;
+}
+
+// Coût d'un '[-]' dans la table : le motif fait 3 caractères mais la boucle
+// tourne autant de fois que la valeur de la cellule au décodage. On ne
+// l'utilise que s'il fait gagner nettement plus qu'un passage par le bouclage.
+#define TABLE_RESET_COST 8
+
+// Les extraits courts sont copiés par blocs de taille fixe (plus rapide qu'un
+// memcpy de longueur variable), d'où une marge en fin de tampon
+#define TABLE_COPY_WIDTH 32
+
+// Table des transitions : pour chaque couple (valeur courante, valeur cible),
+// l'extrait Brainfuck le plus court, '.' final compris, stocké dans un pool commun
+static char* transition_pool = NULL;
+static unsigned int transition_offset[256][256];
+static unsigned char transition_length[256][256];
+static size_t transition_max = 0;  // Plus long extrait de la table
+
+// Boucle de multiplication utilisant la cellule voisine comme compteur :
+// ">" puis factor fois '+', "[<" puis multiplier fois op, ">-]<", puis un reste.
+// La cellule voisine revient toujours à 0, elle peut donc resservir.
+#define MUL_MAX_FACTOR 32
+
+typedef struct {
+    unsigned char factor;
+    unsigned char multiplier;
+    char op;
+    size_t length;  // Longueur totale, reste compris
+} MulLoop;
+
+static MulLoop mul_loops[256];  // Meilleure factorisation pour chaque écart
+
+// Longueur d'un écart parcouru uniquement avec '+' ou '-', bouclage compris
+static size_t deltaCost(unsigned char delta) {
+    return (delta <= 128) ? delta : 256 - (size_t)delta;
+}
+
+static size_t emitDelta(char* out, unsigned char delta) {
+    size_t count = deltaCost(delta);
+    if (out) memset(out, (delta <= 128) ? '+' : '-', count);
+    return count;
+}
+
+static void buildMulLoops(void) {
+    for (int delta = 0; delta < 256; delta++) {
+        MulLoop best = {0, 0, '+', (size_t)-1};
+        for (int factor = 2; factor <= MUL_MAX_FACTOR; factor++) {
+            for (int multiplier = 2; multiplier <= MUL_MAX_FACTOR; multiplier++) {
+                for (int sign = 1; sign >= -1; sign -= 2) {
+                    unsigned char rest = (unsigned char)(delta - sign * factor * multiplier);
+                    size_t length = 7 + factor + multiplier + deltaCost(rest);
+                    if (length < best.length) {
+                        best.factor = (unsigned char)factor;
+                        best.multiplier = (unsigned char)multiplier;
+                        best.op = (sign > 0) ? '+' : '-';
+                        best.length = length;
+                    }
+                }
+            }
+        }
+        mul_loops[delta] = best;
+    }
+}
+
+static size_t emitMulLoop(char* out, unsigned char delta) {
+    const MulLoop* loop = &mul_loops[delta];
+    if (out) {
+        char* p = out;
+        *p++ = '>';
+        memset(p, '+', loop->factor);
+        p += loop->factor;
+        *p++ = '[';
+        *p++ = '<';
+        memset(p, loop->op, loop->multiplier);
+        p += loop->multiplier;
+        memcpy(p, ">-]<", 4);
+        p += 4;
+        int sign = (loop->op == '+') ? 1 : -1;
+        emitDelta(p, (unsigned char)(delta - sign * loop->factor * loop->multiplier));
+    }
+    return loop->length;
+}
+
+// Plus court chemin pour ajouter delta à la cellule courante
+static size_t emitAdd(char* out, unsigned char delta) {
+    if (mul_loops[delta].length < deltaCost(delta)) {
+        return emitMulLoop(out, delta);
+    }
+    return emitDelta(out, delta);
+}
+
+static size_t addCost(unsigned char delta) {
+    size_t direct = deltaCost(delta);
+    return (mul_loops[delta].length < direct) ? mul_loops[delta].length : direct;
+}
+
+// Écrit (si out n'est pas NULL) la transition de current vers target et retourne sa longueur
+static size_t buildTransition(unsigned char current, unsigned char target, char* out) {
+    // Le bouclage sur 8 bits permet de passer par 255 -> 0
+    unsigned char delta = (unsigned char)(target - current);
+    size_t length = 0;
+
+    if (current != 0 && TABLE_RESET_COST + addCost(target) < addCost(delta)) {
+        if (out) memcpy(out, "[-]", 3);
+        length = 3;
+        delta = target;
+    }
+
+    length += emitAdd(out ? out + length : NULL, delta);
+    if (out) out[length] = '.';
+    return length + 1;
+}
+
+void initBrainfuckTable(void) {
+    if (transition_pool) {
+        return;
+    }
+
+    buildMulLoops();
+
+    // Premier passage : longueurs et taille totale du pool
+    size_t pool_size = 0;
+    for (int current = 0; current < 256; current++) {
+        for (int target = 0; target < 256; target++) {
+            size_t length = buildTransition((unsigned char)current, (unsigned char)target, NULL);
+            transition_offset[current][target] = (unsigned int)pool_size;
+            transition_length[current][target] = (unsigned char)length;
+            if (length > transition_max) transition_max = length;
+            pool_size += length;
+        }
+    }
+
+    // Marge en fin de pool pour les copies de taille fixe de singleCellStep
+    char* pool = (char*)malloc(pool_size + TABLE_COPY_WIDTH);
+    if (!pool) {
+        fprintf(stderr, "Erreur d'allocation mémoire pour la table de transitions\n");
+        exit(1);
+    }
+
+    // Second passage : écriture des extraits
+    for (int current = 0; current < 256; current++) {
+        for (int target = 0; target < 256; target++) {
+            buildTransition((unsigned char)current, (unsigned char)target,
+                            pool + transition_offset[current][target]);
+        }
+    }
+    transition_pool = pool;
+}
+
+// Agrandit le tampon de sortie pour qu'il puisse recevoir needed octets de plus
+static int growCode(char** bf_code, size_t bf_index, size_t* max_size, size_t needed) {
+    if (bf_index + needed < *max_size) {
+        return 0;
+    }
+    size_t new_size = *max_size * 2;
+    if (new_size <= bf_index + needed) {
+        new_size = bf_index + needed + 1;
+    }
+    char* temp = (char*)realloc(*bf_code, new_size);
+    if (!temp) {
+        fprintf(stderr, "Erreur de réallocation mémoire\n");
+        return -1;
+    }
+    *bf_code = temp;
+    *max_size = new_size;
+    return 0;
+}
+
+// Mode multi-cellules : le registre i occupe la cellule 2*i, la cellule
+// impaire suivante sert de compteur aux boucles de multiplication de la table
+
+// Pire cas par octet : traverser tous les registres puis l'extrait le plus long
+static size_t registerWorstStep(int registers) {
+    return 2 * (size_t)(registers - 1) + transition_max;
+}
+
+static size_t registerStepCost(const BfRegisterState* state, int target_register, unsigned char target_value) {
+    return (size_t)abs(target_register - state->pointer) * 2
+           + transition_length[state->values[target_register]][target_value];
+}
+
+// Écrit le déplacement vers target_register puis la transition ; retourne la nouvelle fin
+static char* emitRegisterStep(char* out, BfRegisterState* state, int target_register, unsigned char target_value) {
+    size_t distance = (size_t)abs(target_register - state->pointer) * 2;
+    memset(out, (target_register > state->pointer) ? '>' : '<', distance);
+    out += distance;
+
+    unsigned char current_value = state->values[target_register];
+    size_t count = transition_length[current_value][target_value];
+    memcpy(out, transition_pool + transition_offset[current_value][target_value], count);
+    out += count;
+
+    state->values[target_register] = target_value;
+    state->pointer = target_register;
+    return out;
+}
+
+static int encodeRegisters(BfEncoder* encoder, const unsigned char* data, size_t length) {
+    int registers = encoder->options.registers;
+    BfRegisterState* state = &encoder->state;
+    size_t worst_step = registerWorstStep(registers);
+
     for (size_t i = 0; i < length; i++) {
         unsigned char target_value = data[i];
-        int diff = target_value - current_value;
-
-        // Réinitialiser la cellule si nécessaire
-        if (abs(diff) > 10) {
-            if (bf_index + 3 >= max_size) {
-                max_size *= 2;
-                bf_code = (char*)realloc(bf_code, max_size);
-                if (!bf_code) {
-                    fprintf(stderr, "Erreur de réallocation mémoire\n");
-                    return NULL;
-                }
+
+        // Registre le moins coûteux (déplacement + transition), le moins récemment utilisé à égalité
+        int best = 0;
+        size_t best_cost = (size_t)-1;
+        for (int r = 0; r < registers; r++) {
+            size_t cost = registerStepCost(state, r, target_value);
+            if (cost < best_cost || (cost == best_cost && encoder->last_used[r] < encoder->last_used[best])) {
+                best = r;
+                best_cost = cost;
+            }
+        }
+
+        if (growCode(&encoder->buffer, encoder->length, &encoder->capacity, worst_step) != 0) {
+            return -1;
+        }
+        encoder->length = emitRegisterStep(encoder->buffer + encoder->length, state, best, target_value) - encoder->buffer;
+        encoder->last_used[best] = ++encoder->position;
+    }
+
+    return 0;
+}
+
+// Recherche en faisceau : à chaque octet, chaque état du faisceau est étendu
+// vers chacun des registres, puis seuls les beam états les moins coûteux
+// (dédoublonnés) sont conservés. Le meilleur chemin d'une fenêtre est figé
+// avant de passer à la suivante.
+#define SEARCH_WINDOW 4096
+
+static const struct {
+    int registers;
+    int beam;
+} search_levels[BF_MAX_LEVEL + 1] = {
+    {0, 0}, {0, 0},  // Niveaux 0 et 1 : algorithme glouton historique
+    {4, 1}, {4, 4}, {8, 4}, {8, 8}, {8, 16}, {8, 32}, {8, 64}, {16, 128}
+};
+
+typedef struct {
+    size_t cost;
+    unsigned long long hash;
+    unsigned short parent;  // Index de l'état d'origine dans le faisceau précédent
+    unsigned char target_register;
+} SearchCandidate;
+
+// Hachage de Zobrist des états (valeurs des registres et position)
+static unsigned long long zobrist_values[BF_MAX_REGISTERS][256];
+static unsigned long long zobrist_pointer[BF_MAX_REGISTERS];
+static int zobrist_ready = 0;
+
+static unsigned long long splitmix64(unsigned long long* seed) {
+    unsigned long long z = (*seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void initZobrist(void) {
+    if (zobrist_ready) {
+        return;
+    }
+    unsigned long long seed = 0x425241494E5A4950ULL;
+    for (int r = 0; r < BF_MAX_REGISTERS; r++) {
+        for (int v = 0; v < 256; v++) {
+            zobrist_values[r][v] = splitmix64(&seed);
+        }
+        zobrist_pointer[r] = splitmix64(&seed);
+    }
+    zobrist_ready = 1;
+}
+
+static unsigned long long hashRegisterState(const BfRegisterState* state, int registers) {
+    unsigned long long hash = zobrist_pointer[state->pointer];
+    for (int r = 0; r < registers; r++) {
+        hash ^= zobrist_values[r][state->values[r]];
+    }
+    return hash;
+}
+
+static void swapCandidates(SearchCandidate* a, SearchCandidate* b) {
+    SearchCandidate temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+// Place les keep candidats les moins coûteux en tête du tableau (sélection
+// rapide à partition en trois : les coûts égaux sont fréquents)
+static void selectCheapest(SearchCandidate* candidates, size_t count, size_t keep) {
+    size_t left = 0;
+    size_t right = count;
+    while (right - left > 1) {
+        size_t pivot = candidates[left + (right - left) / 2].cost;
+        size_t lower = left;
+        size_t index = left;
+        size_t upper = right;
+        while (index < upper) {
+            if (candidates[index].cost < pivot) {
+                swapCandidates(&candidates[lower++], &candidates[index++]);
+            } else if (candidates[index].cost > pivot) {
+                swapCandidates(&candidates[index], &candidates[--upper]);
+            } else {
+                index++;
             }
-            bf_code[bf_index++] = '[';
-            bf_code[bf_index++] = '-';
-            bf_code[bf_index++] = ']';
-            current_value = 0;
-            diff = target_value;
         }
+        // [lower, upper) contient les coûts égaux au pivot
+        if (keep < lower) {
+            right = lower;
+        } else if (keep > upper) {
+            left = upper;
+        } else {
+            return;
+        }
+    }
+}
+
+static int encodeSearch(BfEncoder* encoder, const unsigned char* data, size_t length) {
+    int level = encoder->options.level;
+    int registers = search_levels[level].registers;
+    size_t beam = (size_t)search_levels[level].beam;
+    size_t candidate_count = beam * (size_t)registers;
+
+    // Table de dédoublonnage indexée par le hachage, invalidée par un numéro de génération
+    size_t dedup_size = 1;
+    while (dedup_size < candidate_count * 2) dedup_size <<= 1;
+
+    BfRegisterState* states = (BfRegisterState*)malloc(2 * beam * sizeof(BfRegisterState));
+    size_t* costs = (size_t*)malloc(2 * beam * sizeof(size_t));
+    unsigned long long* hashes = (unsigned long long*)malloc(2 * beam * sizeof(unsigned long long));
+    SearchCandidate* candidates = (SearchCandidate*)malloc(candidate_count * sizeof(SearchCandidate));
+    size_t* dedup_slots = (size_t*)malloc(dedup_size * sizeof(size_t));
+    size_t* dedup_generation = (size_t*)calloc(dedup_size, sizeof(size_t));
+    unsigned short* history_parent = (unsigned short*)malloc(SEARCH_WINDOW * beam * sizeof(unsigned short));
+    unsigned char* history_register = (unsigned char*)malloc(SEARCH_WINDOW * beam);
+    unsigned char* choices = (unsigned char*)malloc(SEARCH_WINDOW);
+
+    size_t worst_step = registerWorstStep(registers);
+    int status = 0;
+
+    if (!states || !costs || !hashes || !candidates || !dedup_slots || !dedup_generation
+        || !history_parent || !history_register || !choices) {
+        fprintf(stderr, "Erreur d'allocation mémoire\n");
+        free(states); free(costs); free(hashes); free(candidates); free(dedup_slots);
+        free(dedup_generation); free(history_parent); free(history_register); free(choices);
+        return -1;
+    }
+    size_t generation = 0;
+
+    // La recherche repart de l'état laissé par l'appel précédent
+    BfRegisterState* start = &encoder->state;
+    for (size_t block = 0; block < length; block += SEARCH_WINDOW) {
+        size_t block_length = length - block;
+        if (block_length > SEARCH_WINDOW) block_length = SEARCH_WINDOW;
 
-        // Générer les '+' ou '-'
-        char op = (diff > 0) ? '+' : '-';
-        int count = abs(diff);
+        BfRegisterState* current = states;
+        BfRegisterState* next = states + beam;
+        size_t* current_costs = costs;
+        size_t* next_costs = costs + beam;
+        unsigned long long* current_hashes = hashes;
+        unsigned long long* next_hashes = hashes + beam;
+        size_t beam_size = 1;
+        current[0] = *start;
+        current_costs[0] = 0;
+        current_hashes[0] = hashRegisterState(start, registers);
 
-        if (bf_index + count >= max_size) {
-            max_size += count * 2;
-            bf_code = (char*)realloc(bf_code, max_size);
-            if (!bf_code) {
-                fprintf(stderr, "Erreur de réallocation mémoire\n");
-                return NULL;
+        for (size_t i = 0; i < block_length; i++) {
+            unsigned char target_value = data[block + i];
+            size_t count = 0;
+            generation++;
+
+            for (size_t b = 0; b < beam_size; b++) {
+                const BfRegisterState* state = &current[b];
+                for (int r = 0; r < registers; r++) {
+                    size_t cost = current_costs[b] + registerStepCost(state, r, target_value);
+                    unsigned long long hash = current_hashes[b]
+                                              ^ zobrist_values[r][state->values[r]] ^ zobrist_values[r][target_value]
+                                              ^ zobrist_pointer[state->pointer] ^ zobrist_pointer[r];
+
+                    size_t slot = (size_t)(hash ^ (hash >> 32)) & (dedup_size - 1);
+                    while (dedup_generation[slot] == generation && candidates[dedup_slots[slot]].hash != hash) {
+                        slot = (slot + 1) & (dedup_size - 1);
+                    }
+                    if (dedup_generation[slot] == generation) {
+                        SearchCandidate* existing = &candidates[dedup_slots[slot]];
+                        if (cost < existing->cost) {
+                            existing->cost = cost;
+                            existing->parent = (unsigned short)b;
+                            existing->target_register = (unsigned char)r;
+                        }
+                        continue;
+                    }
+                    dedup_generation[slot] = generation;
+                    dedup_slots[slot] = count;
+                    candidates[count].cost = cost;
+                    candidates[count].hash = hash;
+                    candidates[count].parent = (unsigned short)b;
+                    candidates[count].target_register = (unsigned char)r;
+                    count++;
+                }
+            }
+
+            if (count > beam) {
+                selectCheapest(candidates, count, beam);
+                count = beam;
             }
+
+            for (size_t c = 0; c < count; c++) {
+                next[c] = current[candidates[c].parent];
+                next[c].values[candidates[c].target_register] = target_value;
+                next[c].pointer = candidates[c].target_register;
+                next_costs[c] = candidates[c].cost;
+                next_hashes[c] = candidates[c].hash;
+                history_parent[i * beam + c] = candidates[c].parent;
+                history_register[i * beam + c] = candidates[c].target_register;
+            }
+
+            BfRegisterState* swap_states = current; current = next; next = swap_states;
+            size_t* swap_costs = current_costs; current_costs = next_costs; next_costs = swap_costs;
+            unsigned long long* swap_hashes = current_hashes; current_hashes = next_hashes; next_hashes = swap_hashes;
+            beam_size = count;
+        }
+
+        // Remonter le meilleur chemin de la fenêtre puis l'émettre
+        size_t best = 0;
+        for (size_t b = 1; b < beam_size; b++) {
+            if (current_costs[b] < current_costs[best]) best = b;
+        }
+        for (size_t i = block_length; i-- > 0;) {
+            choices[i] = history_register[i * beam + best];
+            best = history_parent[i * beam + best];
+        }
+
+        if (growCode(&encoder->buffer, encoder->length, &encoder->capacity, block_length * worst_step) != 0) {
+            status = -1;
+            break;
+        }
+        char* out = encoder->buffer + encoder->length;
+        for (size_t i = 0; i < block_length; i++) {
+            out = emitRegisterStep(out, start, choices[i], data[block + i]);
         }
+        encoder->length = out - encoder->buffer;
+    }
+
+    free(states); free(costs); free(hashes); free(candidates); free(dedup_slots);
+    free(dedup_generation); free(history_parent); free(history_register); free(choices);
 
-        for (int j = 0; j < count; j++) {
-            bf_code[bf_index++] = op;
+    return status;
+}
+
+// Détection des longues suites d'octets identiques. Une suite est écrite
+// une fois normalement, puis répétée par des boucles de sortie comptées
+// utilisant les cellules 1, 2, ... comme compteurs (toujours rendues à 0) :
+// ">+++[<.>-]<" écrit 3 fois la cellule 0, et chaque niveau d'imbrication
+// supplémentaire multiplie par 255 ("-" met un compteur à 255).
+#define RUN_MIN_LENGTH 32
+#define RUN_DIRECT_OUTPUTS 12  // En dessous, une suite de '.' est plus courte qu'une boucle
+
+// Nombre d'octets égaux à data[0] au début de data
+static size_t runLength(const unsigned char* data, size_t length) {
+    size_t i = 1;
+#if defined(__AVX2__)
+    __m256i value = _mm256_set1_epi8((char)data[0]);
+    while (i + 32 <= length) {
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), value));
+        if (mask != 0xFFFFFFFFu) {
+            return i + __builtin_ctz(~mask);
+        }
+        i += 32;
+    }
+#elif defined(__SSE2__)
+    __m128i value = _mm_set1_epi8((char)data[0]);
+    while (i + 16 <= length) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), value));
+        if (mask != 0xFFFF) {
+            return i + __builtin_ctz(~mask);
         }
+        i += 16;
+    }
+#endif
+    while (i < length && data[i] == data[0]) {
+        i++;
+    }
+    return i;
+}
 
-        // Ajouter '.'
-        if (bf_index + 1 >= max_size) {
-            max_size *= 2;
-            bf_code = (char*)realloc(bf_code, max_size);
-            if (!bf_code) {
-                fprintf(stderr, "Erreur de réallocation mémoire\n");
-                return NULL;
+// Cherche la prochaine suite d'au moins RUN_MIN_LENGTH octets ; retourne sa
+// position (length si aucune) et sa longueur dans run
+static size_t findRun(const unsigned char* data, size_t length, size_t* run) {
+    size_t i = 0;
+    while (i + RUN_MIN_LENGTH <= length) {
+#if defined(__AVX2__)
+        // Sauter les blocs sans deux octets voisins égaux
+        if (i + 33 <= length) {
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i*)(data + i)),
+                _mm256_loadu_si256((const __m256i*)(data + i + 1))));
+            if (mask == 0) {
+                i += 32;
+                continue;
             }
+            i += __builtin_ctz(mask);
         }
-        bf_code[bf_index++] = '.';
-        current_value = target_value;
+#elif defined(__SSE2__)
+        if (i + 17 <= length) {
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_loadu_si128((const __m128i*)(data + i)),
+                _mm_loadu_si128((const __m128i*)(data + i + 1))));
+            if (mask == 0) {
+                i += 16;
+                continue;
+            }
+            i += __builtin_ctz(mask);
+        }
+#endif
+        size_t count = runLength(data + i, length - i);
+        if (count >= RUN_MIN_LENGTH) {
+            *run = count;
+            return i;
+        }
+        i += count;
     }
+    *run = 0;
+    return length;
+}
 
-    // Terminer la chaîne
-    if (bf_index >= max_size) {
-        max_size += 1;
-        bf_code = (char*)realloc(bf_code, max_size);
-        if (!bf_code) {
-            fprintf(stderr, "Erreur de réallocation mémoire\n");
-            return NULL;
+// Mise d'un compteur à count (1 à 255), bouclage compris
+static size_t emitCounter(char* out, size_t count) {
+    return emitDelta(out, (unsigned char)count);
+}
+
+// Écrit (si out n'est pas NULL) une boucle imbriquée sur depth compteurs,
+// le premier à count et les suivants à 255, et retourne sa longueur
+static size_t emitOutputLoop(char* out, size_t count, int depth) {
+    size_t length = 0;
+    for (int level = 0; level < depth; level++) {
+        if (out) out[length] = '>';
+        length++;
+        length += emitCounter(out ? out + length : NULL, (level == 0) ? count : 255);
+        if (out) out[length] = '[';
+        length++;
+    }
+    if (out) {
+        memset(out + length, '<', depth);
+        out[length + depth] = '.';
+        memset(out + length + depth + 1, '>', depth);
+    }
+    length += 2 * (size_t)depth + 1;
+    for (int level = 0; level < depth; level++) {
+        if (out) memcpy(out + length, "-]<", 3);
+        length += 3;
+    }
+    return length;
+}
+
+// Répète count fois la sortie de la cellule 0 : count est décomposé en base 255,
+// le chiffre de rang k devenant une boucle sur k + 1 compteurs
+static size_t emitRepeat(char* out, size_t count) {
+    size_t length = 0;
+    size_t digits[16];
+    int digit_count = 0;
+    while (count > 0) {
+        digits[digit_count++] = count % 255;
+        count /= 255;
+    }
+    for (int k = digit_count - 1; k >= 0; k--) {
+        if (digits[k] == 0) {
+            continue;
+        }
+        if (k == 0 && digits[k] <= RUN_DIRECT_OUTPUTS) {
+            if (out) memset(out + length, '.', digits[k]);
+            length += digits[k];
+        } else {
+            length += emitOutputLoop(out ? out + length : NULL, digits[k], k + 1);
         }
     }
-    bf_code[bf_index] = '\0';
+    return length;
+}
 
-    return bf_code;
+// Extrait d'un octet pour les modes à une seule cellule. En mode table, les
+// extraits courts sont copiés par blocs fixes : out doit avoir TABLE_COPY_WIDTH
+// octets de marge (BF_INTO_SLACK pour les segments gloutons vectoriels).
+static size_t singleCellStep(char* out, BfEncodeMode mode, unsigned char current, unsigned char target) {
+    if (mode == BF_MODE_TABLE) {
+        const char* snippet = transition_pool + transition_offset[current][target];
+        size_t count = transition_length[current][target];
+        if (out) {
+            memcpy(out, snippet, (count <= TABLE_COPY_WIDTH) ? TABLE_COPY_WIDTH : count);
+        }
+        return count;
+    }
+    if (out) {
+        return greedyStep(out, current, target) - out;
+    }
+    return greedyStepSize(current, target);
 }
 
-unsigned char* fromBrainfuck(const char* input, size_t* output_length) {
-    size_t size = strlen(input);
-    unsigned char cells[CELL_SIZE] = {0};
-    size_t index = 0;
-    size_t code_ptr = 0;
-
-    size_t output_size = size;
-    unsigned char* output = (unsigned char*)malloc(output_size * sizeof(unsigned char));
-    if (!output) {
-        fprintf(stderr, "Erreur d'allocation mémoire pour le tampon de sortie\n");
+// Encode à partir de current_value en une seule cellule, avec ou sans boucles
+// de répétition ; écrit dans out s'il n'est pas NULL et retourne la longueur
+static size_t singleCellCode(const unsigned char* data, size_t length, BfEncodeMode mode, int runs,
+                             unsigned char current_value, char* out) {
+    size_t bf_size = 0;
+    size_t i = 0;
+    while (i < length) {
+        size_t run = 0;
+        size_t run_start = runs ? i + findRun(data + i, length - i, &run) : length;
+        if (mode == BF_MODE_GREEDY && run_start > i) {
+            // Segment sans suite : noyau glouton vectoriel
+            if (out) {
+                bf_size += greedyWrite(data + i, run_start - i, current_value, out + bf_size) - (out + bf_size);
+            } else {
+                bf_size += greedySize(data + i, run_start - i, current_value);
+            }
+            current_value = data[run_start - 1];
+            i = run_start;
+        }
+        for (; i < run_start; i++) {
+            bf_size += singleCellStep(out ? out + bf_size : NULL, mode, current_value, data[i]);
+            current_value = data[i];
+        }
+        if (run > 0) {
+            bf_size += singleCellStep(out ? out + bf_size : NULL, mode, current_value, data[i]);
+            current_value = data[i];
+            bf_size += emitRepeat(out ? out + bf_size : NULL, run - 1);
+            i += run;
+        }
+    }
+    return bf_size;
+}
+
+static int encodeSingleCell(BfEncoder* encoder, const unsigned char* data, size_t length) {
+    BfEncodeMode mode = encoder->options.mode;
+    int runs = encoder->options.runs;
+    unsigned char current_value = encoder->state.values[0];
+
+    // Taille exacte calculée à l'avance : une seule réservation par appel
+    size_t bf_size = singleCellCode(data, length, mode, runs, current_value, NULL);
+    if (growCode(&encoder->buffer, encoder->length, &encoder->capacity, bf_size + BF_INTO_SLACK) != 0) {
+        return -1;
+    }
+    singleCellCode(data, length, mode, runs, current_value, encoder->buffer + encoder->length);
+    encoder->length += bf_size;
+
+    if (length > 0) {
+        encoder->state.values[0] = data[length - 1];
+    }
+    return 0;
+}
+
+void bfEncoderInit(BfEncoder* encoder, const BfEncodeOptions* options) {
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->options = *options;
+    if (encoder->options.registers < 1) encoder->options.registers = 1;
+    if (encoder->options.registers > BF_MAX_REGISTERS) encoder->options.registers = BF_MAX_REGISTERS;
+    if (encoder->options.level < 2) encoder->options.level = 2;
+    if (encoder->options.level > BF_MAX_LEVEL) encoder->options.level = BF_MAX_LEVEL;
+
+    if (options->mode != BF_MODE_GREEDY) {
+        initBrainfuckTable();
+    }
+    if (options->mode == BF_MODE_SEARCH) {
+        initZobrist();
+    }
+}
+
+// Repart d'une bande vierge (nouveau fichier) en conservant le tampon de sortie
+void bfEncoderReset(BfEncoder* encoder) {
+    memset(&encoder->state, 0, sizeof(encoder->state));
+    memset(encoder->last_used, 0, sizeof(encoder->last_used));
+    encoder->position = 0;
+}
+
+// Encode un morceau à la suite des précédents. Le code retourné (terminé par
+// '\0') reste valide jusqu'au prochain appel ; NULL en cas d'erreur.
+const char* bfEncoderFeed(BfEncoder* encoder, const unsigned char* data, size_t length, size_t* bf_length) {
+    int status;
+    encoder->length = 0;
+    switch (encoder->options.mode) {
+        case BF_MODE_REGISTERS:
+            status = encodeRegisters(encoder, data, length);
+            break;
+        case BF_MODE_SEARCH:
+            status = encodeSearch(encoder, data, length);
+            break;
+        case BF_MODE_TABLE:
+        case BF_MODE_GREEDY:
+        default:
+            status = encodeSingleCell(encoder, data, length);
+            break;
+    }
+
+    if (status != 0 || growCode(&encoder->buffer, encoder->length, &encoder->capacity, 0) != 0) {
         return NULL;
     }
-    size_t output_index = 0;
+    encoder->buffer[encoder->length] = '\0';
+    if (bf_length) {
+        *bf_length = encoder->length;
+    }
+    return encoder->buffer;
+}
 
-    while (code_ptr < size) {
-        char c = input[code_ptr];
+void bfEncoderFree(BfEncoder* encoder) {
+    free(encoder->buffer);
+    encoder->buffer = NULL;
+    encoder->length = 0;
+    encoder->capacity = 0;
+}
 
-        switch (c) {
-            case '>':
-                index++;
-                if (index >= CELL_SIZE) {
-                    fprintf(stderr, "Erreur : Dépassement de la mémoire à droite\n");
-                    free(output);
-                    return NULL;
-                }
+char* toBrainfuckWith(const unsigned char* data, size_t length, const BfEncodeOptions* options) {
+    if (options->mode == BF_MODE_GREEDY && !options->runs) {
+        return toBrainfuck(data, length);
+    }
+
+    BfEncoder encoder;
+    bfEncoderInit(&encoder, options);
+    if (!bfEncoderFeed(&encoder, data, length, NULL)) {
+        bfEncoderFree(&encoder);
+        return NULL;
+    }
+
+    // Le tampon de l'encodeur devient le résultat
+    return encoder.buffer;
+}
+
+// Indice + 1 de chaque commande dans BF_PACKED_COMMANDS, 0 pour les autres caractères
+static const unsigned char packedIndex[256] = {
+    ['+'] = 1, ['-'] = 2, ['<'] = 3, ['>'] = 4, ['.'] = 5, [','] = 6, ['['] = 7, [']'] = 8
+};
+
+static unsigned char* packToken(unsigned char* out, int command, size_t count) {
+    if (count < 32) {
+        *out++ = (unsigned char)(count << 3 | (size_t)command);
+        return out;
+    }
+    *out++ = (unsigned char)command;
+    while (count >= 0x80) {
+        *out++ = (unsigned char)(count & 0x7F) | 0x80;
+        count >>= 7;
+    }
+    *out++ = (unsigned char)count;
+    return out;
+}
+
+void bfPackInit(BfPacker* packer) {
+    packer->command = -1;
+    packer->count = 0;
+}
+
+// Longueur de la suite de c qui commence à code[i]
+static size_t spanChar(const char* code, size_t i, size_t length, char c) {
+    size_t start = i;
+#if defined(__SSE2__)
+    __m128i value = _mm_set1_epi8(c);
+    while (i + 16 <= length) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(code + i)), value));
+        if (mask != 0xFFFF) {
+            return i - start + (size_t)__builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < length && code[i] == c) {
+        i++;
+    }
+    return i - start;
+}
+
+size_t bfPack(BfPacker* packer, const char* code, size_t length, unsigned char* out) {
+    unsigned char* start = out;
+    int command = packer->command;
+    size_t count = packer->count;
+    size_t i = 0;
+    while (i < length) {
+        int c = packedIndex[(unsigned char)code[i]] - 1;
+        size_t run = spanChar(code, i, length, code[i]);
+        i += run;
+        if (c < 0) {
+            continue;
+        }
+        if (c == command) {
+            count += run;
+        } else {
+            if (command >= 0) {
+                out = packToken(out, command, count);
+            }
+            command = c;
+            count = run;
+        }
+        while (count > BF_PACKED_MAX_RUN) {
+            out = packToken(out, command, BF_PACKED_MAX_RUN);
+            count -= BF_PACKED_MAX_RUN;
+        }
+    }
+    packer->command = command;
+    packer->count = count;
+    return (size_t)(out - start);
+}
+
+size_t bfPackFinish(BfPacker* packer, unsigned char* out) {
+    size_t written = 0;
+    if (packer->command >= 0) {
+        written = (size_t)(packToken(out, packer->command, packer->count) - out);
+    }
+    bfPackInit(packer);
+    return written;
+}
+
+void bfUnpackInit(BfPackedReader* reader) {
+    reader->command = 0;
+    reader->count = 0;
+    reader->shift = -1;
+}
+
+// Lit le prochain jeton à partir de *position : 1 s'il est complet, 0 à la fin
+// du morceau (un jeton coupé reprend au suivant), -1 si sa longueur est invalide
+static inline int packedNext(BfPackedReader* reader, const unsigned char* data, size_t length, size_t* position,
+                             int* command, size_t* count) {
+    size_t i = *position;
+    // Cas courant : jeton d'un seul octet
+    if (reader->shift < 0 && i < length && (data[i] >> 3)) {
+        *command = data[i] & 7;
+        *count = data[i] >> 3;
+        *position = i + 1;
+        return 1;
+    }
+    while (i < length) {
+        unsigned char byte = data[i++];
+        if (reader->shift < 0) {
+            if (byte >> 3) {
+                *command = byte & 7;
+                *count = byte >> 3;
+                *position = i;
+                return 1;
+            }
+            reader->command = byte;
+            reader->count = 0;
+            reader->shift = 0;
+            continue;
+        }
+        reader->count |= (size_t)(byte & 0x7F) << reader->shift;
+        reader->shift += 7;
+        if (reader->count > BF_PACKED_MAX_RUN || ((byte & 0x80) && reader->shift >= 14)) {
+            return -1;
+        }
+        if (!(byte & 0x80)) {
+            reader->shift = -1;
+            if (reader->count == 0) {
+                return -1;
+            }
+            *command = reader->command;
+            *count = reader->count;
+            *position = i;
+            return 1;
+        }
+    }
+    *position = i;
+    return 0;
+}
+
+int bfUnpack(BfPackedReader* reader, const unsigned char* data, size_t length, BfWriteCallback write, void* context) {
+    char text[BF_PACKED_MAX_RUN * 4];
+    size_t used = 0;
+    size_t position = 0;
+    int command;
+    size_t count;
+    int token;
+    while ((token = packedNext(reader, data, length, &position, &command, &count)) > 0) {
+        if (used + count > sizeof(text)) {
+            if (write(context, (const unsigned char*)text, used) != BF_OK) {
+                return BF_ERROR_WRITE;
+            }
+            used = 0;
+        }
+        memset(text + used, BF_PACKED_COMMANDS[command], count);
+        used += count;
+    }
+    if (token < 0) {
+        return BF_ERROR_INVALID_CHAR;
+    }
+    if (used > 0 && write(context, (const unsigned char*)text, used) != BF_OK) {
+        return BF_ERROR_WRITE;
+    }
+    return BF_OK;
+}
+
+int bfUnpackFinish(const BfPackedReader* reader) {
+    return (reader->shift < 0) ? BF_OK : BF_ERROR_INVALID_CHAR;
+}
+
+// Le code glouton n'utilise que '+', '-', '.' et "[-]" sur une seule cellule :
+// chaque octet est la somme des '+'/'-' depuis le dernier "[-]", modulo 256.
+// Ce sous-ensemble se décode en un seul passage, sans compilation.
+#define GREEDY_NOT_LINEAR (-1)
+
+#ifdef GREEDY_VECTOR_WIDTH
+
+// Nombre de bits à 1 ; sans instruction POPCNT, calcul en parallèle sur le mot
+static inline int greedyCount(unsigned long long mask) {
+#if defined(__POPCNT__)
+    return __builtin_popcountll(mask);
+#else
+    mask -= (mask >> 1) & 0x5555555555555555ull;
+    mask = (mask & 0x3333333333333333ull) + ((mask >> 2) & 0x3333333333333333ull);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((mask * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Masques des caractères du bloc ; other marque ceux hors du sous-ensemble
+typedef struct {
+    unsigned long long plus, minus, dot, open, close, other;
+} GreedyMasks;
+
+// Bloc fait uniquement de '+' : cas courant des octets éloignés du précédent
+static int greedyAllPlus(const char* block, GreedyMasks* masks) {
+    masks->minus = masks->dot = masks->open = masks->close = masks->other = 0;
+#if defined(__AVX512BW__)
+    masks->plus = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)block), _mm512_set1_epi8('+'));
+    return masks->plus == ~0ull;
+#elif defined(__AVX2__)
+    masks->plus = (unsigned int)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)block), _mm256_set1_epi8('+')));
+    return masks->plus == 0xFFFFFFFFull;
+#else
+    masks->plus = (unsigned int)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)block), _mm_set1_epi8('+')));
+    return masks->plus == 0xFFFFull;
+#endif
+}
+
+static void greedyMasks(const char* block, GreedyMasks* masks) {
+#if defined(__AVX512BW__)
+    __m512i v = _mm512_loadu_si512((const void*)block);
+    masks->plus = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('+'));
+    masks->minus = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('-'));
+    masks->dot = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('.'));
+    masks->open = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('['));
+    masks->close = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(']'));
+    unsigned long long lines = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n'))
+                               | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+    masks->other = ~(masks->plus | masks->minus | masks->dot | masks->open | masks->close | lines);
+#elif defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256((const __m256i*)block);
+    masks->plus = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('+')));
+    masks->minus = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+    masks->dot = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')));
+    masks->open = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')));
+    masks->close = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')));
+    unsigned long long lines = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+    masks->other = ~(masks->plus | masks->minus | masks->dot | masks->open | masks->close | lines) & 0xFFFFFFFFull;
+#else
+    __m128i v = _mm_loadu_si128((const __m128i*)block);
+    masks->plus = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('+')));
+    masks->minus = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+    masks->dot = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')));
+    masks->open = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')));
+    masks->close = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(']')));
+    unsigned long long lines = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    masks->other = ~(masks->plus | masks->minus | masks->dot | masks->open | masks->close | lines) & 0xFFFFull;
+#endif
+}
+
+#endif
+
+#ifdef GREEDY_VECTOR_WIDTH
+
+// Crochets et '-' du bloc ; retourne le masque des caractères qui ne sont ni une
+// commande ni un saut de ligne. '+', ',', '-' et '.' se suivent dans la table
+// ASCII : un seul test d'intervalle (v - '+' <= 3, non signé) les couvre.
+static unsigned long long commandMasks(const char* block, unsigned long long* open, unsigned long long* close,
+                                       unsigned long long* minus) {
+#if defined(__AVX512BW__)
+    __m512i v = _mm512_loadu_si512((const void*)block);
+    *open = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('['));
+    *close = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(']'));
+    *minus = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('-'));
+    unsigned long long valid = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('+')), _mm512_set1_epi8(3))
+                               | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('<'))
+                               | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('>'))
+                               | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n'))
+                               | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+    return ~(valid | *open | *close);
+#elif defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256((const __m256i*)block);
+    __m256i open_v = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('['));
+    __m256i close_v = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']'));
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('+'));
+    __m256i valid = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(3)), shifted);
+    valid = _mm256_or_si256(valid, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('<')),
+                                                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('>'))));
+    valid = _mm256_or_si256(valid, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+    valid = _mm256_or_si256(valid, _mm256_or_si256(open_v, close_v));
+    *open = (unsigned int)_mm256_movemask_epi8(open_v);
+    *close = (unsigned int)_mm256_movemask_epi8(close_v);
+    *minus = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+    return ~(unsigned long long)(unsigned int)_mm256_movemask_epi8(valid) & 0xFFFFFFFFull;
+#else
+    __m128i v = _mm_loadu_si128((const __m128i*)block);
+    __m128i open_v = _mm_cmpeq_epi8(v, _mm_set1_epi8('['));
+    __m128i close_v = _mm_cmpeq_epi8(v, _mm_set1_epi8(']'));
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('+'));
+    __m128i valid = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(3)), shifted);
+    valid = _mm_or_si128(valid, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('<')),
+                                             _mm_cmpeq_epi8(v, _mm_set1_epi8('>'))));
+    valid = _mm_or_si128(valid, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                             _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    valid = _mm_or_si128(valid, _mm_or_si128(open_v, close_v));
+    *open = (unsigned int)_mm_movemask_epi8(open_v);
+    *close = (unsigned int)_mm_movemask_epi8(close_v);
+    *minus = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+    return ~(unsigned long long)(unsigned int)_mm_movemask_epi8(valid) & 0xFFFFull;
+#endif
+}
+
+#endif
+
+int bfValidate(const char* code, size_t length, size_t* depth_state) {
+    size_t depth = *depth_state;
+    size_t i = 0;
+#ifdef GREEDY_VECTOR_WIDTH
+    for (; i + GREEDY_VECTOR_WIDTH <= length; i += GREEDY_VECTOR_WIDTH) {
+        GreedyMasks plus;
+        if (greedyAllPlus(code + i, &plus)) {
+            continue;
+        }
+        unsigned long long open, close, minus;
+        if (commandMasks(code + i, &open, &close, &minus) != 0) {
+            break;  // La version scalaire signale la première erreur du bloc
+        }
+        // Les "[-]" entiers du bloc s'annulent ; s'il reste assez de crochets
+        // ouverts, l'ordre des autres n'importe pas
+        unsigned long long resets = open & (minus >> 1) & (close >> 2);
+        open &= ~resets;
+        close &= ~(resets << 2);
+        size_t closing = (size_t)greedyCount(close);
+        if (closing <= depth) {
+            depth = depth + (size_t)greedyCount(open) - closing;
+            continue;
+        }
+        for (unsigned long long brackets = open | close; brackets; brackets &= brackets - 1) {
+            if (brackets & (0 - brackets) & open) {
+                depth++;
+            } else if (depth-- == 0) {
+                return BF_ERROR_UNMATCHED_CLOSE;
+            }
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        switch (code[i]) {
+            case '[':
+                depth++;
                 break;
-            case '<':
-                if (index == 0) {
-                    fprintf(stderr, "Erreur : Dépassement de la mémoire à gauche\n");
-                    free(output);
-                    return NULL;
+            case ']':
+                if (depth-- == 0) {
+                    return BF_ERROR_UNMATCHED_CLOSE;
                 }
-                index--;
                 break;
-            case '+':
-                cells[index]++;
+            case '+': case '-': case '<': case '>': case '.': case ',': case '\n': case '\r':
                 break;
-            case '-':
-                cells[index]--;
-                break;
-            case '.':
-                if (output_index >= output_size) {
-                    output_size *= 2;
-                    unsigned char* temp = (unsigned char*)realloc(output, output_size * sizeof(unsigned char));
-                    if (!temp) {
-                        fprintf(stderr, "Erreur de réallocation de mémoire pour le tampon de sortie\n");
-                        free(output);
-                        return NULL;
-                    }
-                    output = temp;
+            default:
+                return BF_ERROR_INVALID_CHAR;
+        }
+    }
+    *depth_state = depth;
+    return BF_OK;
+}
+
+// Décode un caractère hors bloc vectoriel ; pending compte les caractères de
+// "[-]" déjà lus. Retourne GREEDY_NOT_LINEAR si le caractère sort du
+// sous-ensemble, sans rien modifier.
+static int greedyDecodeChar(char c, unsigned char* value, int* pending, BfOutput* output) {
+    if (*pending > 0) {
+        if (c != ((*pending == 1) ? '-' : ']')) {
+            return GREEDY_NOT_LINEAR;
+        }
+        if (*pending == 2) {
+            *value = 0;
+            *pending = 0;
+        } else {
+            *pending = 2;
+        }
+        return BF_OK;
+    }
+    switch (c) {
+        case '+':
+            (*value)++;
+            return BF_OK;
+        case '-':
+            (*value)--;
+            return BF_OK;
+        case '.': {
+            int status;
+            if (output->length >= output->capacity && (status = bfOutputReserve(output, 1)) != BF_OK) {
+                return status;
+            }
+            output->data[output->length++] = *value;
+            return BF_OK;
+        }
+        case '[':
+            *pending = 1;
+            return BF_OK;
+        case '\n':
+        case '\r':
+            return BF_OK;
+        default:
+            return GREEDY_NOT_LINEAR;
+    }
+}
+
+// Comme greedyDecodeChar pour une suite de count commandes identiques
+static int greedyDecodeRun(char c, size_t count, unsigned char* value, int* pending, BfOutput* output) {
+    if (*pending > 0 || c == '[') {
+        return (count == 1) ? greedyDecodeChar(c, value, pending, output) : GREEDY_NOT_LINEAR;
+    }
+    switch (c) {
+        case '+':
+            *value += (unsigned char)count;
+            return BF_OK;
+        case '-':
+            *value -= (unsigned char)count;
+            return BF_OK;
+        case '.':
+            while (count > 0) {
+                int status;
+                if (output->length >= output->capacity && (status = bfOutputReserve(output, 1)) != BF_OK) {
+                    return status;
                 }
-                output[output_index++] = cells[index];
-                break;
-            case ',':
-                cells[index] = 0;
-                break;
-            case '[':
-                if (cells[index] == 0) {
-                    int loop = 1;
-                    while (loop > 0) {
-                        code_ptr++;
-                        if (code_ptr >= size) {
-                            fprintf(stderr, "Erreur : '[' non apparié\n");
-                            free(output);
-                            return NULL;
-                        }
-                        if (input[code_ptr] == '[') loop++;
-                        else if (input[code_ptr] == ']') loop--;
-                    }
+                size_t part = output->capacity - output->length;
+                if (part > count) {
+                    part = count;
                 }
+                memset(output->data + output->length, *value, part);
+                output->length += part;
+                count -= part;
+            }
+            return BF_OK;
+        default:
+            return GREEDY_NOT_LINEAR;
+    }
+}
+
+// Décode du code glouton à partir de *position ; s'arrête sur le premier
+// caractère hors du sous-ensemble (GREEDY_NOT_LINEAR) ou à la fin du morceau
+// (BF_OK). La sortie produite jusque-là reste valable : value et pending
+// permettent de reprendre au morceau suivant ou de passer à l'interprète.
+static int decodeGreedy(const char* input, size_t size, size_t* position,
+                        unsigned char* value_state, int* pending_state, BfOutput* output) {
+    unsigned char value = *value_state;
+    int pending = *pending_state;
+    size_t i = *position;
+    int status = BF_OK;
+#ifdef GREEDY_VECTOR_WIDTH
+    while (status == BF_OK && i + GREEDY_VECTOR_WIDTH <= size) {
+        // Au plus un octet produit par caractère du bloc ; près de la fin d'une
+        // destination fixe, le bloc passe par la version scalaire qui
+        // réserve octet par octet
+        int room = 1;
+        if (output->length + GREEDY_VECTOR_WIDTH > output->capacity
+            && (status = bfOutputReserve(output, GREEDY_VECTOR_WIDTH)) != BF_OK) {
+            if (status != BF_ERROR_OUTPUT_SIZE) {
                 break;
-            case ']':
-                if (cells[index] != 0) {
-                    int loop = 1;
-                    code_ptr--;
-                    while (loop > 0) {
-                        if (code_ptr == 0) {
-                            fprintf(stderr, "Erreur : ']' non apparié\n");
-                            free(output);
-                            return NULL;
-                        }
-                        if (input[code_ptr] == ']') loop++;
-                        else if (input[code_ptr] == '[') loop--;
-                        code_ptr--;
-                    }
-                    code_ptr++;
+            }
+            status = BF_OK;
+            room = 0;
+        }
+
+        GreedyMasks masks;
+        if (room && pending == 0 && greedyAllPlus(input + i, &masks)) {
+            value += GREEDY_VECTOR_WIDTH;
+            i += GREEDY_VECTOR_WIDTH;
+            continue;
+        }
+        greedyMasks(input + i, &masks);
+
+        // "[-]" entièrement dans le bloc ; tout autre crochet passe par la version scalaire
+        unsigned long long resets = masks.open & (masks.minus >> 1) & (masks.close >> 2);
+        if (!room || pending > 0 || masks.other != 0 || resets != masks.open || (resets << 2) != masks.close) {
+            size_t end = i + GREEDY_VECTOR_WIDTH;
+            for (; i < size && (i < end || pending > 0); i++) {
+                if ((status = greedyDecodeChar(input[i], &value, &pending, output)) != BF_OK) {
+                    break;
                 }
-                break;
-            default:
-                break;
+            }
+            continue;
+        }
+
+        // Le '-' de "[-]" ne compte pas ; chaque '.' ou "[-]" coupe la somme
+        unsigned long long plus = masks.plus;
+        unsigned long long minus = masks.minus & ~(resets << 1);
+        unsigned long long events = masks.dot | resets;
+        while (events) {
+            unsigned long long bit = events & (0 - events);
+            unsigned long long before = bit - 1;
+            value += (unsigned char)(greedyCount(plus & before) - greedyCount(minus & before));
+            plus &= ~before;
+            minus &= ~before;
+            if (bit & masks.dot) {
+                output->data[output->length++] = value;
+            } else {
+                value = 0;
+            }
+            events ^= bit;
+        }
+        value += (unsigned char)(greedyCount(plus) - greedyCount(minus));
+        i += GREEDY_VECTOR_WIDTH;
+    }
+#endif
+    for (; status == BF_OK && i < size; i++) {
+        if ((status = greedyDecodeChar(input[i], &value, &pending, output)) != BF_OK) {
+            break;
+        }
+    }
+    *position = i;
+    *value_state = value;
+    *pending_state = pending;
+    return status;
+}
+
+// Exécute le programme compilé jusqu'ici puis le vide ; la bande et le
+// pointeur sont conservés pour le segment suivant
+static int runSegment(BfDecoder* decoder) {
+    BfProgram* program = &decoder->compiler.program;
+    int status = bfCompilerFinish(&decoder->compiler);
+    if (status != BF_OK) {
+        return status;
+    }
+    // Chaque instruction au moins une fois ; les tours de boucle sont décomptés par les moteurs
+    BfMachine* machine = &decoder->machine;
+    if ((machine->fuel -= (long long)program->length) < 0 && (status = bfMachineRefuel(machine)) != BF_OK) {
+        return status;
+    }
+
+    status = BF_ERROR_UNSUPPORTED;
+    if (decoder->options.engine == BF_ENGINE_JIT) {
+        status = bfJitRun(machine, program);
+    } else if (decoder->options.engine == BF_ENGINE_THREADED) {
+        status = bfRunThreaded(machine, program);
+    }
+    if (status == BF_ERROR_UNSUPPORTED) {
+        status = bfRun(machine, program);
+    }
+    program->length = 0;
+    return status;
+}
+
+// Passe du décodage glouton à l'interprète : la cellule courante reprend la
+// valeur calculée, un "[" ou "[-" déjà lu est redonné au compilateur
+static int leaveLinear(BfDecoder* decoder) {
+    static const char* prefixes[] = {"", "[", "[-"};
+    if (bfTapeInit(&decoder->machine) != BF_OK) {
+        return BF_ERROR_MEMORY;
+    }
+    decoder->linear = 0;
+    decoder->machine.tape[0] = decoder->value;
+    return bfCompilerFeed(&decoder->compiler, prefixes[decoder->pending], (size_t)decoder->pending);
+}
+
+int bfDecoderInit(BfDecoder* decoder, const BfDecodeOptions* options, BfWriteCallback write, void* context) {
+    decoder->options = *options;
+    decoder->linear = 1;
+    decoder->value = 0;
+    decoder->pending = 0;
+    decoder->brackets = 0;
+    bfUnpackInit(&decoder->packed);
+    bfCompilerInit(&decoder->compiler);
+    if (bfMachineInit(&decoder->machine, BF_DECODER_WINDOW) != BF_OK) {
+        return BF_ERROR_MEMORY;
+    }
+    bfMachineLimit(&decoder->machine, options->max_steps, options->timeout);
+    decoder->machine.output.flush = write;
+    decoder->machine.output.context = context;
+    return BF_OK;
+}
+
+// Prépare le décodeur pour un nouveau code en gardant ses tampons et sa bande
+void bfDecoderReset(BfDecoder* decoder, void* context) {
+    BfOutput* output = &decoder->machine.output;
+    if (output->fixed) {
+        *output = decoder->stream;
+    }
+    bfDecoderRestart(decoder);
+    output->length = 0;
+    output->context = context;
+    bfMachineLimit(&decoder->machine, decoder->options.max_steps, decoder->options.timeout);
+}
+
+// Le code suivant repart d'une bande vierge, mais sa sortie prolonge celle du
+// précédent et les limites d'exécution restent celles du fichier en cours
+void bfDecoderRestart(BfDecoder* decoder) {
+    decoder->linear = 1;
+    decoder->value = 0;
+    decoder->pending = 0;
+    decoder->brackets = 0;
+    bfUnpackInit(&decoder->packed);
+    decoder->compiler.program.length = 0;
+    decoder->compiler.depth = 0;
+    bfTapeReset(&decoder->machine);
+}
+
+// Comme bfDecoderReset, mais la sortie est écrite directement dans
+// destination ; la dépasser arrête le décodage avec BF_ERROR_OUTPUT_SIZE
+void bfDecoderResetInto(BfDecoder* decoder, unsigned char* destination, size_t capacity) {
+    bfDecoderReset(decoder, NULL);
+    BfOutput* output = &decoder->machine.output;
+    decoder->stream = *output;
+    output->data = destination;
+    output->length = 0;
+    output->capacity = capacity;
+    output->flush = NULL;
+    output->context = NULL;
+    output->fixed = 1;
+}
+
+int bfDecoderFeed(BfDecoder* decoder, const char* chunk, size_t length) {
+    size_t position = 0;
+    if (decoder->options.validate) {
+        int status = bfValidate(chunk, length, &decoder->brackets);
+        if (status != BF_OK) {
+            return status;
+        }
+    }
+    if (decoder->linear) {
+        int status = decodeGreedy(chunk, length, &position, &decoder->value, &decoder->pending,
+                                  &decoder->machine.output);
+        // Le décodage glouton ne boucle pas : un caractère, une instruction
+        BfMachine* machine = &decoder->machine;
+        if ((machine->fuel -= (long long)position) < 0) {
+            int limit = bfMachineRefuel(machine);
+            if (limit != BF_OK) {
+                return limit;
+            }
+        }
+        if (status == BF_OK) {
+            return BF_OK;
+        }
+        if (status != GREEDY_NOT_LINEAR || (status = leaveLinear(decoder)) != BF_OK) {
+            return status;
+        }
+    }
+
+    // Compilation par tranches : dès que toutes les boucles sont fermées, le
+    // code accumulé est exécuté, ce qui borne la taille du programme en mémoire
+    while (position < length) {
+        size_t slice = length - position;
+        if (slice > BF_DECODER_SLICE) {
+            slice = BF_DECODER_SLICE;
+        }
+        int status = bfCompilerFeed(&decoder->compiler, chunk + position, slice);
+        if (status == BF_OK && decoder->compiler.depth == 0
+            && decoder->compiler.program.length >= BF_DECODER_SEGMENT) {
+            status = runSegment(decoder);
+        }
+        if (status != BF_OK) {
+            return status;
+        }
+        position += slice;
+    }
+    return BF_OK;
+}
+
+// Jetons compactés d'un seul octet du code glouton ("[-]" en trois jetons) :
+// décodés sans appel tant qu'ils le sont et que la sortie a de la place.
+// Retourne le nombre d'instructions équivalentes.
+static size_t decodePackedGreedy(const unsigned char* data, size_t length, size_t* position,
+                                 unsigned char* value, BfOutput* output) {
+    static const unsigned char reset[3] = {1 << 3 | 6, 1 << 3 | 1, 1 << 3 | 7};
+    size_t i = *position;
+    size_t steps = 0;
+    unsigned char v = *value;
+    while (i < length) {
+        unsigned char byte = data[i];
+        size_t count = byte >> 3;
+        if (count == 0) {
+            break;
+        }
+        if ((byte & 7) == 0) {
+            v += (unsigned char)count;
+        } else if ((byte & 7) == 1) {
+            v -= (unsigned char)count;
+        } else if ((byte & 7) == 4 && output->capacity - output->length >= count) {
+            memset(output->data + output->length, v, count);
+            output->length += count;
+        } else if (byte == reset[0] && length - i >= 3 && memcmp(data + i, reset, 3) == 0) {
+            v = 0;
+            i += 2;
+            count = 3;
+        } else {
+            break;
+        }
+        i++;
+        steps += count;
+    }
+    *position = i;
+    *value = v;
+    return steps;
+}
+
+int bfDecoderFeedPacked(BfDecoder* decoder, const unsigned char* chunk, size_t length) {
+    BfMachine* machine = &decoder->machine;
+    size_t position = 0;
+    int command;
+    size_t count;
+    int token;
+    if (decoder->options.validate) {
+        // Les longueurs sont vérifiées par la lecture elle-même, il reste les crochets
+        BfPackedReader reader = decoder->packed;
+        while ((token = packedNext(&reader, chunk, length, &position, &command, &count)) > 0) {
+            if (command == 6) {
+                decoder->brackets += count;
+            } else if (command == 7) {
+                if (count > decoder->brackets) {
+                    return BF_ERROR_UNMATCHED_CLOSE;
+                }
+                decoder->brackets -= count;
+            }
         }
-        code_ptr++;
+        if (token < 0) {
+            return BF_ERROR_INVALID_CHAR;
+        }
+        position = 0;
+    }
+
+    for (;;) {
+        int status;
+        if (decoder->linear && decoder->pending == 0 && decoder->packed.shift < 0) {
+            size_t steps = decodePackedGreedy(chunk, length, &position, &decoder->value, &machine->output);
+            if ((machine->fuel -= (long long)steps) < 0 && (status = bfMachineRefuel(machine)) != BF_OK) {
+                return status;
+            }
+        }
+        if ((token = packedNext(&decoder->packed, chunk, length, &position, &command, &count)) <= 0) {
+            break;
+        }
+        if (decoder->linear) {
+            status = greedyDecodeRun(BF_PACKED_COMMANDS[command], count, &decoder->value, &decoder->pending,
+                                     &machine->output);
+            if (status != GREEDY_NOT_LINEAR) {
+                // Autant d'instructions que de caractères dans le texte
+                if (status == BF_OK && (machine->fuel -= (long long)count) < 0) {
+                    status = bfMachineRefuel(machine);
+                }
+                if (status != BF_OK) {
+                    return status;
+                }
+                continue;
+            }
+            if ((status = leaveLinear(decoder)) != BF_OK) {
+                return status;
+            }
+        }
+        status = bfCompilerFeedRun(&decoder->compiler, BF_PACKED_COMMANDS[command], count);
+        if (status == BF_OK && decoder->compiler.depth == 0
+            && decoder->compiler.program.length >= BF_DECODER_SEGMENT) {
+            status = runSegment(decoder);
+        }
+        if (status != BF_OK) {
+            return status;
+        }
+    }
+    return (token < 0) ? BF_ERROR_INVALID_CHAR : BF_OK;
+}
+
+int bfDecoderFinish(BfDecoder* decoder) {
+    int status = BF_OK;
+    if (decoder->options.validate && decoder->brackets > 0) {
+        return BF_ERROR_UNMATCHED_OPEN;
+    }
+    if (bfUnpackFinish(&decoder->packed) != BF_OK) {
+        return BF_ERROR_INVALID_CHAR;
+    }
+    if (decoder->linear) {
+        // Un "[" ou "[-" laissé en suspens n'est pas du code glouton complet
+        if (decoder->pending > 0) {
+            status = leaveLinear(decoder);
+        }
+    }
+    if (status == BF_OK && !decoder->linear) {
+        status = runSegment(decoder);
+    }
+
+    BfOutput* output = &decoder->machine.output;
+    if (status == BF_OK && output->flush && output->length > 0) {
+        if (output->flush(output->context, output->data, output->length) != BF_OK) {
+            status = BF_ERROR_WRITE;
+        }
+        output->length = 0;
+    }
+    return status;
+}
+
+void bfDecoderFree(BfDecoder* decoder) {
+    if (decoder->machine.output.fixed) {
+        decoder->machine.output = decoder->stream;
+    }
+    bfCompilerFree(&decoder->compiler);
+    bfMachineFree(&decoder->machine);
+}
+
+unsigned char* fromBrainfuck(const char* input, size_t* output_length) {
+    BfDecodeOptions options = {BF_ENGINE_THREADED, 0, 0, 0};
+    return fromBrainfuckWith(input, output_length, &options);
+}
+
+unsigned char* fromBrainfuckWith(const char* input, size_t* output_length, const BfDecodeOptions* options) {
+    BfDecoder decoder;
+    if (bfDecoderInit(&decoder, options, NULL, NULL) != BF_OK) {
+        fprintf(stderr, "Erreur d'allocation mémoire pour le tampon de sortie\n");
+        return NULL;
+    }
+
+    // Sans fonction d'écriture, toute la sortie reste dans le tampon de la machine
+    int status = bfDecoderFeed(&decoder, input, strlen(input));
+    if (status == BF_OK) {
+        status = bfDecoderFinish(&decoder);
+    }
+    if (status != BF_OK) {
+        fprintf(stderr, "Erreur : %s\n", bfErrorMessage(status));
+        bfDecoderFree(&decoder);
+        return NULL;
     }
 
+    BfOutput* result = &decoder.machine.output;
     if (output_length) {
-        *output_length = output_index;
+        *output_length = result->length;
+    }
+
+    // Une sortie vide garde son tampon : realloc(…, 0) le libérerait
+    unsigned char* output = result->data;
+    if (result->length > 0) {
+        unsigned char* final_output = (unsigned char*)realloc(output, result->length * sizeof(unsigned char));
+        if (final_output) {
+            output = final_output;
+        }
+    }
+    result->data = NULL;
+    bfDecoderFree(&decoder);
+    return output;
+}
+
+// Décode vers une destination fournie, dimensionnée d'après la taille connue
+// de la sortie (métadonnées de l'archive) : ni copie ni réallocation. Retourne
+// BF_ERROR_OUTPUT_SIZE dès que le code écrirait au-delà de capacity.
+// Décodage d'un code entier, en texte ou compacté, vers une destination fixe
+static int decodeInto(const char* input, size_t length, int packed, unsigned char* destination, size_t capacity,
+                      size_t* output_length, const BfDecodeOptions* options) {
+    BfDecoder decoder;
+    if (bfDecoderInit(&decoder, options, NULL, NULL) != BF_OK) {
+        return BF_ERROR_MEMORY;
+    }
+    bfDecoderResetInto(&decoder, destination, capacity);
+
+    int status = packed ? bfDecoderFeedPacked(&decoder, (const unsigned char*)input, length)
+                        : bfDecoderFeed(&decoder, input, length);
+    if (status == BF_OK) {
+        status = bfDecoderFinish(&decoder);
+    }
+    if (output_length) {
+        *output_length = decoder.machine.output.length;
+    }
+    bfDecoderFree(&decoder);
+    return status;
+}
+
+int fromBrainfuckInto(const char* input, size_t length, unsigned char* destination, size_t capacity,
+                      size_t* output_length, const BfDecodeOptions* options) {
+    return decodeInto(input, length, 0, destination, capacity, output_length, options);
+}
+
+// Compte la sortie d'un code entièrement glouton : un octet par '.'.
+// Retourne 0 dès qu'un caractère sort du sous-ensemble.
+static int greedyOutputLength(const char* input, size_t length, size_t* output_length) {
+    size_t outputs = 0;
+    size_t i = 0;
+    int pending = 0;
+    while (i < length) {
+        size_t end = length;
+#ifdef GREEDY_VECTOR_WIDTH
+        if (i + GREEDY_VECTOR_WIDTH <= length) {
+            GreedyMasks masks;
+            if (pending == 0 && greedyAllPlus(input + i, &masks)) {
+                i += GREEDY_VECTOR_WIDTH;
+                continue;
+            }
+            greedyMasks(input + i, &masks);
+            unsigned long long resets = masks.open & (masks.minus >> 1) & (masks.close >> 2);
+            if (pending == 0 && masks.other == 0 && resets == masks.open && (resets << 2) == masks.close) {
+                outputs += (size_t)greedyCount(masks.dot);
+                i += GREEDY_VECTOR_WIDTH;
+                continue;
+            }
+            end = i + GREEDY_VECTOR_WIDTH;
+        }
+#endif
+        for (; i < length && (i < end || pending > 0); i++) {
+            char c = input[i];
+            if (pending > 0) {
+                if (c != "[-]"[pending]) {
+                    return 0;
+                }
+                pending = (pending + 1) % 3;
+            } else if (c == '[') {
+                pending = 1;
+            } else if (c == '.') {
+                outputs++;
+            } else if (c != '+' && c != '-' && c != '\n' && c != '\r') {
+                return 0;
+            }
+        }
+    }
+    *output_length = outputs;
+    return pending == 0;
+}
+
+// Comme greedyOutputLength pour un code compacté : jetons d'un octet lus sans
+// appel, "[-]" fait des trois jetons reconnus par decodePackedGreedy ; seuls
+// les jetons longs passent par packedNext, qui vérifie leur longueur
+static int packedGreedyOutputLength(const unsigned char* input, size_t length, size_t* output_length) {
+    static const unsigned char reset[3] = {1 << 3 | 6, 1 << 3 | 1, 1 << 3 | 7};
+    size_t outputs = 0;
+    size_t i = 0;
+    while (i < length) {
+        unsigned char byte = input[i];
+        int command = byte & 7;
+        size_t count = byte >> 3;
+        if (count == 0) {
+            BfPackedReader reader;
+            bfUnpackInit(&reader);
+            if (packedNext(&reader, input, length, &i, &command, &count) <= 0) {
+                return 0;
+            }
+        } else if (byte == reset[0]) {
+            if (length - i < 3 || input[i + 1] != reset[1] || input[i + 2] != reset[2]) {
+                return 0;
+            }
+            i += 3;
+            continue;
+        } else {
+            i++;
+        }
+        if (command == 4) {
+            outputs += count;
+        } else if (command > 1) {
+            return 0;
+        }
+    }
+    *output_length = outputs;
+    return 1;
+}
+
+#ifdef PARALLEL_DECODE
+
+// Morceau du décodage parallèle. Sans destination, le morceau est seulement
+// mesuré : longueur de sa sortie et état de la bande à la fin.
+typedef struct {
+    const char* input;
+    size_t length;
+    int packed;   // Code compacté plutôt qu'en texte
+    const BfDecodeOptions* options;
+    unsigned char* destination;
+    size_t output_length;
+    int status;
+    int clean;    // Toutes les cellules nulles sauf la cellule courante
+    int last;     // Dernier morceau : sa bande finale n'importe pas
+    int* failed;  // Partagé : un morceau inutilisable arrête la mesure des autres
+} ParallelPart;
+
+static int countOutput(void* context, const unsigned char* data, size_t length) {
+    (void)data;
+    *(size_t*)context += length;
+    return BF_OK;
+}
+
+static int tapeClean(const BfMachine* machine) {
+    for (size_t i = 0; i < machine->tape_size; i++) {
+        if (machine->tape[i] != 0 && i != machine->pointer) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void measurePart(ParallelPart* part) {
+    // Code glouton : une seule cellule, la sortie se compte sans rien exécuter
+    if (part->packed ? packedGreedyOutputLength((const unsigned char*)part->input, part->length, &part->output_length)
+                     : greedyOutputLength(part->input, part->length, &part->output_length)) {
+        part->status = BF_OK;
+        part->clean = 1;
+        return;
+    }
+
+    size_t count = 0;
+    BfDecoder decoder;
+    if (bfDecoderInit(&decoder, part->options, countOutput, &count) != BF_OK) {
+        part->status = BF_ERROR_MEMORY;
+        return;
+    }
+    part->status = BF_OK;
+    for (size_t position = 0; part->status == BF_OK && position < part->length; position += BF_PARALLEL_MIN_PART) {
+        if (__atomic_load_n(part->failed, __ATOMIC_RELAXED)) {
+            part->status = BF_ERROR_UNSUPPORTED;
+            break;
+        }
+        size_t slice = part->length - position;
+        if (slice > BF_PARALLEL_MIN_PART) {
+            slice = BF_PARALLEL_MIN_PART;
+        }
+        part->status = part->packed ? bfDecoderFeedPacked(&decoder, (const unsigned char*)part->input + position, slice)
+                                    : bfDecoderFeed(&decoder, part->input + position, slice);
+    }
+    if (part->status == BF_OK) {
+        part->status = bfDecoderFinish(&decoder);
+    }
+    part->output_length = count;
+    part->clean = decoder.linear || tapeClean(&decoder.machine);
+    if (part->status != BF_OK || (!part->clean && !part->last)) {
+        __atomic_store_n(part->failed, 1, __ATOMIC_RELAXED);
+    }
+    bfDecoderFree(&decoder);
+}
+
+static void* decodePart(void* argument) {
+    ParallelPart* part = (ParallelPart*)argument;
+    if (!part->destination) {
+        measurePart(part);
+        return NULL;
+    }
+    size_t length = 0;
+    part->status = decodeInto(part->input, part->length, part->packed, part->destination, part->output_length,
+                              &length, part->options);
+    if (part->status == BF_OK && length != part->output_length) {
+        part->status = BF_ERROR_OUTPUT_SIZE;
+    }
+    return NULL;
+}
+
+// Un fil par morceau, le premier restant sur le fil appelant ; un fil refusé
+// par le système laisse ses morceaux au fil appelant
+static void runParts(ParallelPart* parts, size_t count) {
+    pthread_t threads[BF_MAX_THREADS];
+    size_t started = 1;
+    while (started < count && pthread_create(&threads[started], NULL, decodePart, &parts[started]) == 0) {
+        started++;
+    }
+    decodePart(&parts[0]);
+    for (size_t i = started; i < count; i++) {
+        decodePart(&parts[i]);
     }
+    for (size_t i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// Premier "[-]" de input[from, to) ; to s'il n'y en a pas
+static size_t findReset(const char* input, size_t from, size_t to) {
+    while (from + 3 <= to) {
+        const char* open = (const char*)memchr(input + from, '[', to - from - 2);
+        if (!open) {
+            break;
+        }
+        from = (size_t)(open - input);
+        if (open[1] == '-' && open[2] == ']') {
+            return from;
+        }
+        from++;
+    }
+    return to;
+}
+
+// Premier "[-]" compacté (trois jetons d'un octet) de input[from, to) qui
+// commence un jeton ; to s'il n'y en a pas. L'octet précédent, ni commande
+// d'un jeton long (< 8) ni octet non final de sa longueur (>= 0x80), termine
+// forcément un jeton.
+static size_t findPackedReset(const unsigned char* input, size_t from, size_t to) {
+    if (from == 0) {
+        from = 1;
+    }
+    while (from + 3 <= to) {
+        const unsigned char* open = (const unsigned char*)memchr(input + from, 1 << 3 | 6, to - from - 2);
+        if (!open) {
+            break;
+        }
+        from = (size_t)(open - input);
+        if (open[1] == (1 << 3 | 1) && open[2] == (1 << 3 | 7) && open[-1] >= 8 && open[-1] < 0x80) {
+            return from;
+        }
+        from++;
+    }
+    return to;
+}
+
+#endif
 
-    unsigned char* final_output = (unsigned char*)realloc(output, output_index * sizeof(unsigned char));
-    if (!final_output) {
-        return output;
+// Décodage parallèle d'un code en texte ou compacté. Après un "[-]", la suite
+// ne dépend plus de ce qui précède si toutes les autres cellules sont nulles :
+// le code est coupé sur de tels points, chaque morceau est d'abord mesuré
+// (taille de sortie, bande propre à la fin), puis décodé directement à sa
+// place dans destination. Tout cas douteux (boucle coupée, bande sale,
+// erreur) repasse par le décodage séquentiel.
+static int decodeParallel(const char* input, size_t length, int packed, unsigned char* destination, size_t capacity,
+                          size_t* output_length, const BfDecodeOptions* options, int threads) {
+#ifdef PARALLEL_DECODE
+    // Les limites portent sur le code entier : elles imposent le décodage séquentiel
+    if (options->max_steps > 0 || options->timeout > 0) {
+        threads = 1;
     }
+    if (threads > BF_MAX_THREADS) {
+        threads = BF_MAX_THREADS;
+    }
+    ParallelPart parts[BF_MAX_THREADS];
+    size_t count = 0;
+    size_t start = 0;
+    for (int k = 1; k < threads; k++) {
+        size_t target = length / (size_t)threads * (size_t)k;
+        size_t next = length / (size_t)threads * (size_t)(k + 1);
+        if (target < start + BF_PARALLEL_MIN_PART) {
+            continue;
+        }
+        size_t split = packed ? findPackedReset((const unsigned char*)input, target, next)
+                              : findReset(input, target, next);
+        if (split == next) {
+            continue;
+        }
+        parts[count].input = input + start;
+        parts[count].length = split - start;
+        count++;
+        start = split;
+    }
+    if (count > 0) {
+        parts[count].input = input + start;
+        parts[count].length = length - start;
+        count++;
+
+        int failed = 0;
+        for (size_t i = 0; i < count; i++) {
+            parts[i].packed = packed;
+            parts[i].options = options;
+            parts[i].destination = NULL;
+            parts[i].last = (i == count - 1);
+            parts[i].failed = &failed;
+        }
+        runParts(parts, count);
+
+        int valid = 1;
+        size_t total = 0;
+        for (size_t i = 0; i < count && valid; i++) {
+            valid = parts[i].status == BF_OK && (parts[i].clean || parts[i].last)
+                    && parts[i].output_length <= capacity - total;
+            total += parts[i].output_length;
+        }
+        if (valid) {
+            size_t offset = 0;
+            for (size_t i = 0; i < count; i++) {
+                parts[i].destination = destination + offset;
+                offset += parts[i].output_length;
+            }
+            runParts(parts, count);
+
+            int status = BF_OK;
+            for (size_t i = 0; i < count && status == BF_OK; i++) {
+                status = parts[i].status;
+            }
+            if (output_length) {
+                *output_length = total;
+            }
+            return status;
+        }
+    }
+#else
+    (void)threads;
+#endif
+    return decodeInto(input, length, packed, destination, capacity, output_length, options);
+}
+
+// Comme fromBrainfuckInto, réparti sur au plus threads fils
+int fromBrainfuckParallel(const char* input, size_t length, unsigned char* destination, size_t capacity,
+                          size_t* output_length, const BfDecodeOptions* options, int threads) {
+    return decodeParallel(input, length, 0, destination, capacity, output_length, options, threads);
+}
 
-    return final_output;
+// Même chose pour un code compacté par bfPack
+int fromPackedParallel(const unsigned char* input, size_t length, unsigned char* destination, size_t capacity,
+                       size_t* output_length, const BfDecodeOptions* options, int threads) {
+    return decodeParallel((const char*)input, length, 1, destination, capacity, output_length, options, threads);
 }
@@ -1,7 +1,160 @@
 #ifndef BRAINFUCK_H
 #define BRAINFUCK_H
 
+#include <stddef.h>
+#include "bytecode.h"
+
+// Modes d'encodage disponibles
+typedef enum {
+    BF_MODE_GREEDY = 0,  // Algorithme historique : réinitialisation au-delà d'un écart de 10
+    BF_MODE_TABLE,       // Table précalculée des transitions les plus courtes (boucles de multiplication comprises)
+    BF_MODE_REGISTERS,   // Plusieurs cellules utilisées comme registres, choisies au coût le plus faible
+    BF_MODE_SEARCH       // Recherche en faisceau sur les registres, largeur fixée par le niveau
+} BfEncodeMode;
+
+#define BF_DEFAULT_REGISTERS 8
+#define BF_MAX_REGISTERS 64
+#define BF_MAX_LEVEL 9
+
+// Paramètres d'encodage
+typedef struct {
+    BfEncodeMode mode;
+    int registers;  // Nombre de registres pour BF_MODE_REGISTERS
+    int level;      // Niveau d'effort pour BF_MODE_SEARCH (2 à BF_MAX_LEVEL)
+    int runs;       // Boucles de sortie pour les longues suites d'octets identiques (modes greedy et table)
+} BfEncodeOptions;
+
+// État des cellules manipulées par l'encodeur
+typedef struct {
+    unsigned char values[BF_MAX_REGISTERS];  // Valeur de chaque registre (seul le premier en mode une cellule)
+    int pointer;                             // Registre sous le pointeur
+} BfRegisterState;
+
+// Encodeur incrémental : l'état des cellules est conservé d'un appel à
+// l'autre, ce qui permet d'encoder un fichier par morceaux de taille fixe
+typedef struct {
+    BfEncodeOptions options;
+    BfRegisterState state;
+    size_t last_used[BF_MAX_REGISTERS];  // Ordre d'utilisation des registres (mode registers)
+    size_t position;                     // Nombre d'octets encodés par le mode registers
+    char* buffer;                        // Code produit par le dernier appel, réutilisé
+    size_t length;
+    size_t capacity;
+} BfEncoder;
+
+void bfEncoderInit(BfEncoder* encoder, const BfEncodeOptions* options);
+void bfEncoderReset(BfEncoder* encoder);
+const char* bfEncoderFeed(BfEncoder* encoder, const unsigned char* data, size_t length, size_t* bf_length);
+void bfEncoderFree(BfEncoder* encoder);
+
+// Marge à prévoir après la taille exacte pour que toBrainfuckInto utilise le noyau vectoriel
+#define BF_INTO_SLACK 64
+
+// Moteurs d'exécution du décodeur, pour le code hors du sous-ensemble glouton
+typedef enum {
+    BF_ENGINE_INTERP = 0,  // Interprète du code intermédiaire (switch)
+    BF_ENGINE_THREADED,    // Code enfilé par goto calculé (GCC/Clang), repli sur l'interprète ailleurs
+    BF_ENGINE_JIT          // Code natif x86-64, repli sur l'interprète ailleurs
+} BfEngine;
+
+// Paramètres de décodage
+typedef struct {
+    BfEngine engine;
+    int validate;                  // Code non fiable : vérifié (bfValidate) avant d'être décodé
+    unsigned long long max_steps;  // Instructions permises par code décodé, 0 : sans limite
+    double timeout;                // Secondes permises par code décodé, 0 : sans limite
+} BfDecodeOptions;
+
+// Taille du tampon de sortie transmis à la fonction d'écriture
+#define BF_DECODER_WINDOW (64 * 1024)
+// Caractères compilés avant de vérifier si le programme peut être exécuté
+#define BF_DECODER_SLICE (64 * 1024)
+// Instructions accumulées avant l'exécution d'un segment sans boucle ouverte
+#define BF_DECODER_SEGMENT (64 * 1024)
+
+// Décodage parallèle : nombre maximal de fils et longueur minimale du code
+// confié à chacun
+#define BF_MAX_THREADS 64
+#define BF_PARALLEL_MIN_PART (1024 * 1024)
+
+// Code compacté : un octet par suite de commandes identiques, l'indice de la
+// commande dans BF_PACKED_COMMANDS sur les 3 bits de poids faible et la
+// longueur (1 à 31) sur les 5 autres. Une longueur 0 annonce la vraie longueur
+// en varint (7 bits par octet, poids faible d'abord). Une suite ne dépasse pas
+// BF_PACKED_MAX_RUN : quelques octets ne peuvent pas réclamer des millions de
+// boucles ouvertes.
+#define BF_PACKED_COMMANDS "+-<>.,[]"
+#define BF_PACKED_MAX_RUN 4096
+#define BF_PACKED_MAX_TOKEN 3
+
+// Suite en cours de compactage
+typedef struct {
+    int command;  // Indice dans BF_PACKED_COMMANDS, -1 : aucune suite
+    size_t count;
+} BfPacker;
+
+// Lecture d'un code compacté, reprise d'un morceau à l'autre
+typedef struct {
+    int command;  // Commande du jeton dont la longueur est en cours de lecture
+    size_t count;
+    int shift;    // Décalage du prochain octet de la varint, -1 : hors jeton
+} BfPackedReader;
+
+// Décodeur incrémental : le code arrive en morceaux quelconques, y compris au
+// milieu d'une boucle, et la sortie est transmise à write par fenêtres de
+// BF_DECODER_WINDOW octets (ou conservée dans machine.output si write est NULL)
+typedef struct {
+    BfDecodeOptions options;
+    BfMachine machine;
+    BfCompiler compiler;
+    int linear;             // Toujours dans le sous-ensemble glouton
+    unsigned char value;    // Cellule du décodage glouton
+    int pending;            // Caractères de "[-]" déjà lus par le décodage glouton
+    BfOutput stream;        // Tampon propre, mis de côté pendant un décodage vers une destination fixe
+    size_t brackets;        // Crochets ouverts vus par la vérification préalable
+    BfPackedReader packed;  // Jeton compacté à cheval sur deux morceaux
+} BfDecoder;
+
+// Vérification préalable d'un code non fiable, vectorisée : seuls les huit
+// commandes et les sauts de ligne sont admis, aucun ']' sans '[' ouvert.
+// depth reprend d'un morceau à l'autre ; il doit valoir 0 à la fin du code.
+int bfValidate(const char* code, size_t length, size_t* depth);
+
+int bfDecoderInit(BfDecoder* decoder, const BfDecodeOptions* options, BfWriteCallback write, void* context);
+void bfDecoderReset(BfDecoder* decoder, void* context);
+void bfDecoderResetInto(BfDecoder* decoder, unsigned char* destination, size_t capacity);
+// Entre deux codes indépendants d'un même fichier (après bfDecoderFinish) :
+// bande et état remis à zéro, sortie et limites conservées
+void bfDecoderRestart(BfDecoder* decoder);
+int bfDecoderFeed(BfDecoder* decoder, const char* chunk, size_t length);
+// Comme bfDecoderFeed pour un code compacté, exécuté sans repasser par le texte
+int bfDecoderFeedPacked(BfDecoder* decoder, const unsigned char* chunk, size_t length);
+int bfDecoderFinish(BfDecoder* decoder);
+void bfDecoderFree(BfDecoder* decoder);
+
+// Compacte length caractères de code, les autres caractères que les commandes
+// étant ignorés ; out doit pouvoir recevoir length + BF_PACKED_MAX_TOKEN octets.
+// La dernière suite attend le morceau suivant, ou bfPackFinish.
+void bfPackInit(BfPacker* packer);
+size_t bfPack(BfPacker* packer, const char* code, size_t length, unsigned char* out);
+size_t bfPackFinish(BfPacker* packer, unsigned char* out);
+// Redonne le texte d'un code compacté à write ; bfUnpackFinish signale un jeton tronqué
+void bfUnpackInit(BfPackedReader* reader);
+int bfUnpack(BfPackedReader* reader, const unsigned char* data, size_t length, BfWriteCallback write, void* context);
+int bfUnpackFinish(const BfPackedReader* reader);
+
 char* toBrainfuck(const unsigned char* data, size_t length);
+size_t toBrainfuckSize(const unsigned char* data, size_t length);
+size_t toBrainfuckInto(const unsigned char* data, size_t length, char* dst, size_t capacity);
+char* toBrainfuckWith(const unsigned char* data, size_t length, const BfEncodeOptions* options);
+void initBrainfuckTable(void);
 unsigned char* fromBrainfuck(const char* input, size_t* output_length);
+unsigned char* fromBrainfuckWith(const char* input, size_t* output_length, const BfDecodeOptions* options);
+int fromBrainfuckInto(const char* input, size_t length, unsigned char* destination, size_t capacity,
+                      size_t* output_length, const BfDecodeOptions* options);
+int fromBrainfuckParallel(const char* input, size_t length, unsigned char* destination, size_t capacity,
+                          size_t* output_length, const BfDecodeOptions* options, int threads);
+int fromPackedParallel(const unsigned char* input, size_t length, unsigned char* destination, size_t capacity,
+                       size_t* output_length, const BfDecodeOptions* options, int threads);
 
 #endif //BRAINFUCK_H
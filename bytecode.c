@@ -0,0 +1,951 @@
+#define _GNU_SOURCE  // memrchr
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include "bytecode.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <unistd.h>
+#include <pthread.h>
+#define TAPE_MMAP
+#endif
+
+#define TAPE_SIZE 30000
+
+// Bande réservée par mmap, rendue accessible page par page
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define TAPE_RESERVED ((size_t)256 << 20)
+#else
+#define TAPE_RESERVED ((size_t)16 << 20)
+#endif
+
+// Nombre maximal de cellules modifiées par une boucle de multiplication
+#define LOOP_MAX_TARGETS 16
+
+// Instructions exécutées entre deux lectures de l'horloge quand une limite est posée
+#define FUEL_SLICE (1LL << 20)
+
+const char* bfErrorMessage(int status) {
+    switch (status) {
+        case BF_OK:
+            return "Aucune erreur";
+        case BF_ERROR_MEMORY:
+            return "Allocation mémoire impossible";
+        case BF_ERROR_UNMATCHED_OPEN:
+            return "'[' non apparié";
+        case BF_ERROR_UNMATCHED_CLOSE:
+            return "']' non apparié";
+        case BF_ERROR_TAPE_LEFT:
+            return "Dépassement de la mémoire à gauche";
+        case BF_ERROR_TAPE_RIGHT:
+            return "Dépassement de la mémoire à droite";
+        case BF_ERROR_UNSUPPORTED:
+            return "Moteur indisponible sur cette plateforme";
+        case BF_ERROR_WRITE:
+            return "Écriture de la sortie impossible";
+        case BF_ERROR_OUTPUT_SIZE:
+            return "Sortie différente de la taille annoncée";
+        case BF_ERROR_INVALID_CHAR:
+            return "Caractère étranger au Brainfuck";
+        case BF_ERROR_STEP_LIMIT:
+            return "Nombre maximal d'instructions atteint";
+        case BF_ERROR_TIMEOUT:
+            return "Délai d'exécution dépassé";
+        case BF_ERROR_CORRUPT:
+            return "Code compressé incohérent";
+        default:
+            return "Erreur inconnue";
+    }
+}
+
+// Longueur de la suite du caractère c commençant à source[i]
+static size_t spanChar(const char* source, size_t i, size_t length, char c) {
+    size_t start = i;
+#if defined(__SSE2__)
+    __m128i value = _mm_set1_epi8(c);
+    while (i + 16 <= length) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(source + i)), value));
+        if (mask != 0xFFFF) {
+            return i - start + __builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < length && source[i] == c) {
+        i++;
+    }
+    return i - start;
+}
+
+// Ajoute une instruction en fin de programme ; retourne NULL si l'agrandissement échoue
+static BfInstruction* emitInstruction(BfProgram* program, int op, long long arg) {
+    if (program->length >= program->capacity) {
+        size_t capacity = (program->capacity == 0) ? 256 : program->capacity * 2;
+        BfInstruction* temp = (BfInstruction*)realloc(program->code, capacity * sizeof(BfInstruction));
+        if (!temp) {
+            return NULL;
+        }
+        program->code = temp;
+        program->capacity = capacity;
+    }
+    BfInstruction* instruction = &program->code[program->length++];
+    instruction->op = op;
+    instruction->offset = 0;
+    instruction->arg = arg;
+    return instruction;
+}
+
+// Regroupe l'opération avec la précédente si elle est de même nature
+static int emitFolded(BfProgram* program, int op, long long arg) {
+    if (op == OP_ADD) {
+        arg &= 255;
+    }
+    if (arg == 0) {
+        return BF_OK;
+    }
+    if (program->length > 0) {
+        BfInstruction* last = &program->code[program->length - 1];
+        if (op == OP_ADD && last->op == OP_SET) {
+            // "[-]+++" : la valeur ajoutée est intégrée à l'affectation
+            last->arg = (last->arg + arg) & 255;
+            return BF_OK;
+        }
+        if (last->op == op) {
+            last->arg += arg;
+            if (op == OP_ADD) {
+                last->arg &= 255;
+            }
+            // "+-" ou "><" s'annulent : l'instruction disparaît
+            if (last->arg == 0) {
+                program->length--;
+            }
+            return BF_OK;
+        }
+    }
+    return emitInstruction(program, op, arg) ? BF_OK : BF_ERROR_MEMORY;
+}
+
+// Remplace la boucle qui vient d'être fermée par son équivalent sans boucle
+// quand elle suit une forme connue ; retourne 1 si la boucle a été remplacée
+static int foldLoop(BfProgram* program, size_t open) {
+    const BfInstruction* body = &program->code[open + 1];
+    size_t count = program->length - open - 2;
+
+    // "[>]", "[<<]" : recherche de la prochaine cellule nulle
+    if (count == 1 && body[0].op == OP_MOVE) {
+        long long step = body[0].arg;
+        program->length = open;
+        emitInstruction(program, OP_SCAN, step);
+        return 1;
+    }
+
+    // Simulation du corps : additions cumulées par décalage, au plus une sortie
+    int offsets[LOOP_MAX_TARGETS];
+    long long deltas[LOOP_MAX_TARGETS];
+    size_t targets = 0;
+    long long position = 0;
+    long long output_offset = 0;
+    long long output_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        switch (body[i].op) {
+            case OP_MOVE:
+                position += body[i].arg;
+                if (position < -0x7fffffffLL || position > 0x7fffffffLL) {
+                    return 0;
+                }
+                break;
+            case OP_ADD: {
+                size_t t = 0;
+                while (t < targets && offsets[t] != (int)position) {
+                    t++;
+                }
+                if (t == targets) {
+                    if (targets == LOOP_MAX_TARGETS) {
+                        return 0;
+                    }
+                    offsets[targets] = (int)position;
+                    deltas[targets++] = 0;
+                }
+                deltas[t] = (deltas[t] + body[i].arg) & 255;
+                break;
+            }
+            case OP_OUTPUT:
+                if (output_count > 0) {
+                    return 0;
+                }
+                output_offset = position;
+                output_count = body[i].arg;
+                break;
+            default:
+                return 0;
+        }
+    }
+    if (position != 0) {
+        return 0;
+    }
+
+    // La cellule de contrôle doit varier de ±1 par tour pour connaître le nombre de tours
+    long long step = 0;
+    for (size_t t = 0; t < targets; t++) {
+        if (offsets[t] == 0) {
+            step = deltas[t];
+        }
+    }
+    if (step != 1 && step != 255) {
+        return 0;
+    }
+
+    if (output_count > 0) {
+        // "[<.>-]" : seule la cellule de contrôle change, la sortie lit une autre cellule
+        if (targets != 1 || output_offset == 0 || step != 255) {
+            return 0;
+        }
+        program->length = open;
+        BfInstruction* instruction = emitInstruction(program, OP_OUTPUT_LOOP, output_count);
+        instruction->offset = (int)output_offset;
+        return 1;
+    }
+
+    // "[->+++<]" : cellule offset += tours × facteur ; "[-]" n'a aucune cible.
+    // Avec "[+...]", le nombre de tours est -cellule : le facteur change de signe.
+    program->length = open;
+    for (size_t t = 0; t < targets; t++) {
+        if (offsets[t] != 0 && deltas[t] != 0) {
+            BfInstruction* instruction = emitInstruction(program, OP_MUL_ADD,
+                                                         (step == 255) ? deltas[t] : (-deltas[t]) & 255);
+            instruction->offset = offsets[t];
+        }
+    }
+    emitInstruction(program, OP_SET, 0);
+    return 1;
+}
+
+void bfCompilerInit(BfCompiler* compiler) {
+    compiler->program.code = NULL;
+    compiler->program.length = 0;
+    compiler->program.capacity = 0;
+    compiler->loops = NULL;
+    compiler->depth = 0;
+    compiler->loop_capacity = 0;
+}
+
+// '[' : pile des boucles ouvertes, leur cible est fixée à la rencontre du ']'
+static int openLoop(BfCompiler* compiler) {
+    if (compiler->depth >= compiler->loop_capacity) {
+        size_t capacity = (compiler->loop_capacity == 0) ? 16 : compiler->loop_capacity * 2;
+        size_t* temp = (size_t*)realloc(compiler->loops, capacity * sizeof(size_t));
+        if (!temp) {
+            return BF_ERROR_MEMORY;
+        }
+        compiler->loops = temp;
+        compiler->loop_capacity = capacity;
+    }
+    compiler->loops[compiler->depth++] = compiler->program.length;
+    return emitInstruction(&compiler->program, OP_JUMP_ZERO, 0) ? BF_OK : BF_ERROR_MEMORY;
+}
+
+static int closeLoop(BfCompiler* compiler) {
+    BfProgram* program = &compiler->program;
+    if (compiler->depth == 0) {
+        return BF_ERROR_UNMATCHED_CLOSE;
+    }
+    size_t open = compiler->loops[--compiler->depth];
+    if (!emitInstruction(program, OP_JUMP_NONZERO, (long long)open + 1)) {
+        return BF_ERROR_MEMORY;
+    }
+    if (!foldLoop(program, open)) {
+        program->code[open].arg = (long long)program->length;
+    }
+    return BF_OK;
+}
+
+int bfCompilerFeed(BfCompiler* compiler, const char* source, size_t length) {
+    BfProgram* program = &compiler->program;
+    int status = BF_OK;
+
+    size_t i = 0;
+    while (i < length && status == BF_OK) {
+        switch (source[i]) {
+            case '+':
+            case '-': {
+                // Toute la suite est lue d'un coup : une seule instruction par suite
+                long long delta = 0;
+                while (i < length && (source[i] == '+' || source[i] == '-')) {
+                    size_t count = spanChar(source, i, length, source[i]);
+                    delta += (source[i] == '+') ? (long long)count : -(long long)count;
+                    i += count;
+                }
+                status = emitFolded(program, OP_ADD, delta);
+                continue;
+            }
+            case '>':
+            case '<': {
+                long long delta = 0;
+                while (i < length && (source[i] == '>' || source[i] == '<')) {
+                    size_t count = spanChar(source, i, length, source[i]);
+                    delta += (source[i] == '>') ? (long long)count : -(long long)count;
+                    i += count;
+                }
+                status = emitFolded(program, OP_MOVE, delta);
+                continue;
+            }
+            case '.': {
+                size_t count = spanChar(source, i, length, '.');
+                i += count;
+                status = emitFolded(program, OP_OUTPUT, (long long)count);
+                continue;
+            }
+            case ',':
+                status = emitInstruction(program, OP_INPUT, 0) ? BF_OK : BF_ERROR_MEMORY;
+                break;
+            case '[':
+                status = openLoop(compiler);
+                break;
+            case ']':
+                status = closeLoop(compiler);
+                break;
+            default:
+                break;
+        }
+        i++;
+    }
+    return status;
+}
+
+int bfCompilerFeedRun(BfCompiler* compiler, char command, unsigned long long count) {
+    BfProgram* program = &compiler->program;
+    int status = BF_OK;
+    switch (command) {
+        case '+':
+            return emitFolded(program, OP_ADD, (long long)(count & 255));
+        case '-':
+            return emitFolded(program, OP_ADD, -(long long)(count & 255));
+        case '>':
+        case '<':
+            if (count > (unsigned long long)LLONG_MAX) {
+                return BF_ERROR_TAPE_RIGHT;
+            }
+            return emitFolded(program, OP_MOVE, (command == '>') ? (long long)count : -(long long)count);
+        case '.':
+            if (count > (unsigned long long)LLONG_MAX) {
+                return BF_ERROR_OUTPUT_SIZE;
+            }
+            return emitFolded(program, OP_OUTPUT, (long long)count);
+        case ',':
+            for (unsigned long long i = 0; i < count && status == BF_OK; i++) {
+                status = emitInstruction(program, OP_INPUT, 0) ? BF_OK : BF_ERROR_MEMORY;
+            }
+            return status;
+        case '[':
+            for (unsigned long long i = 0; i < count && status == BF_OK; i++) {
+                status = openLoop(compiler);
+            }
+            return status;
+        case ']':
+            for (unsigned long long i = 0; i < count && status == BF_OK; i++) {
+                status = closeLoop(compiler);
+            }
+            return status;
+        default:
+            return BF_OK;
+    }
+}
+
+// Termine le programme en cours par OP_END ; toutes les boucles doivent être fermées
+int bfCompilerFinish(BfCompiler* compiler) {
+    if (compiler->depth > 0) {
+        return BF_ERROR_UNMATCHED_OPEN;
+    }
+    return emitInstruction(&compiler->program, OP_END, 0) ? BF_OK : BF_ERROR_MEMORY;
+}
+
+void bfCompilerFree(BfCompiler* compiler) {
+    free(compiler->program.code);
+    free(compiler->loops);
+    bfCompilerInit(compiler);
+}
+
+#ifdef TAPE_MMAP
+// Partie de la bande accessible dès le départ : une page, la seule à remettre
+// à zéro après un petit programme
+static size_t tapeWindow(void) {
+    static size_t window = 0;
+    if (window == 0) {
+        long page = sysconf(_SC_PAGESIZE);
+        window = (page > 0) ? (size_t)page : 4096;
+    }
+    return window;
+}
+
+// Dernière bande libérée par chaque thread, remise à zéro : la réserver à
+// nouveau coûterait plusieurs appels système par fichier décodé. Celle d'un
+// thread qui se termine (décodage parallèle) est rendue au système.
+static pthread_key_t spare_key;
+static pthread_once_t spare_once = PTHREAD_ONCE_INIT;
+static int spare_ready = 0;
+
+static void unmapTape(unsigned char* tape) {
+    munmap(tape - BF_TAPE_GUARD, BF_TAPE_GUARD + TAPE_RESERVED + BF_TAPE_GUARD);
+}
+
+static void freeSpareTape(void* tape) {
+    unmapTape((unsigned char*)tape);
+}
+
+static void createSpareKey(void) {
+    spare_ready = (pthread_key_create(&spare_key, freeSpareTape) == 0);
+}
+
+static unsigned char* spareTape(void) {
+    pthread_once(&spare_once, createSpareKey);
+    return spare_ready ? (unsigned char*)pthread_getspecific(spare_key) : NULL;
+}
+#endif
+
+// Réserve la bande entre deux zones PROT_NONE, seule la première page
+// étant accessible ; sans mmap, ou si la réservation est refusée, bande fixe
+// de TAPE_SIZE cellules
+int bfTapeInit(BfMachine* machine) {
+    if (machine->tape) {
+        return BF_OK;
+    }
+    machine->pointer = 0;
+#ifdef TAPE_MMAP
+    machine->tape_limit = TAPE_RESERVED;
+    machine->guarded = 1;
+    unsigned char* spare = spareTape();
+    if (spare) {
+        pthread_setspecific(spare_key, NULL);
+        machine->tape = spare;
+        machine->tape_size = tapeWindow();
+        return BF_OK;
+    }
+    size_t total = BF_TAPE_GUARD + TAPE_RESERVED + BF_TAPE_GUARD;
+    unsigned char* region = (unsigned char*)mmap(NULL, total, PROT_NONE,
+                                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region != MAP_FAILED) {
+        if (mprotect(region + BF_TAPE_GUARD, tapeWindow(), PROT_READ | PROT_WRITE) == 0) {
+            machine->tape = region + BF_TAPE_GUARD;
+            machine->tape_size = tapeWindow();
+            return BF_OK;
+        }
+        munmap(region, total);
+    }
+#endif
+    machine->tape = (unsigned char*)calloc(TAPE_SIZE, sizeof(unsigned char));
+    machine->tape_size = TAPE_SIZE;
+    machine->tape_limit = TAPE_SIZE;
+    machine->guarded = 0;
+    return machine->tape ? BF_OK : BF_ERROR_MEMORY;
+}
+
+// Rend la cellule position accessible en agrandissant la partie accessible
+// de la bande (au moins du double) ; une position « négative » apparaît
+// comme très grande et donne un dépassement à gauche
+int bfTapeReach(BfMachine* machine, size_t position) {
+    if (position < machine->tape_size) {
+        return BF_OK;
+    }
+    if (position > SIZE_MAX / 2) {
+        return BF_ERROR_TAPE_LEFT;
+    }
+    if (position >= machine->tape_limit) {
+        return BF_ERROR_TAPE_RIGHT;
+    }
+#ifdef TAPE_MMAP
+    size_t window = tapeWindow();
+    size_t size = machine->tape_size * 2;
+    if (size <= position) {
+        size = (position / window + 1) * window;
+    }
+    if (size > machine->tape_limit) {
+        size = machine->tape_limit;
+    }
+    if (mprotect(machine->tape + machine->tape_size, size - machine->tape_size, PROT_READ | PROT_WRITE) != 0) {
+        return BF_ERROR_MEMORY;
+    }
+    machine->tape_size = size;
+    return BF_OK;
+#else
+    return BF_ERROR_TAPE_RIGHT;
+#endif
+}
+
+// Remet la bande à zéro pour un nouveau programme : seule la partie
+// accessible a pu être modifiée, ramenée à une page
+void bfTapeReset(BfMachine* machine) {
+    machine->pointer = 0;
+    if (!machine->tape) {
+        return;
+    }
+#ifdef TAPE_MMAP
+    size_t window = tapeWindow();
+    if (machine->guarded && machine->tape_size > window) {
+        madvise(machine->tape + window, machine->tape_size - window, MADV_DONTNEED);
+        mprotect(machine->tape + window, machine->tape_size - window, PROT_NONE);
+        machine->tape_size = window;
+    }
+#endif
+    memset(machine->tape, 0, machine->tape_size);
+}
+
+static void tapeFree(BfMachine* machine) {
+#ifdef TAPE_MMAP
+    if (machine->guarded) {
+        if (!spareTape() && spare_ready) {
+            bfTapeReset(machine);
+            if (pthread_setspecific(spare_key, machine->tape) == 0) {
+                return;
+            }
+        }
+        unmapTape(machine->tape);
+        return;
+    }
+#endif
+    free(machine->tape);
+}
+
+int bfMachineInit(BfMachine* machine, size_t output_capacity) {
+    machine->tape = NULL;
+    machine->tape_size = 0;
+    machine->tape_limit = 0;
+    machine->pointer = 0;
+    machine->guarded = 0;
+    bfMachineLimit(machine, 0, 0);
+    if (bfOutputInit(&machine->output, output_capacity) != BF_OK) {
+        return BF_ERROR_MEMORY;
+    }
+    return BF_OK;
+}
+
+void bfMachineFree(BfMachine* machine) {
+    if (machine->tape) {
+        tapeFree(machine);
+    }
+    if (!machine->output.fixed) {
+        free(machine->output.data);
+    }
+    machine->tape = NULL;
+    machine->output.data = NULL;
+    machine->output.length = 0;
+    machine->output.capacity = 0;
+}
+
+static double clockSeconds(void) {
+    struct timespec now;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    timespec_get(&now, TIME_UTC);
+#endif
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+// Sans limite, fuel ne s'épuise jamais en pratique : les moteurs ne
+// rappellent pas bfMachineRefuel
+static void grantFuel(BfMachine* machine) {
+    long long grant = LLONG_MAX;
+    if (machine->deadline > 0) {
+        grant = FUEL_SLICE;
+    }
+    if (machine->max_steps > 0 && machine->max_steps - machine->steps < (unsigned long long)grant) {
+        grant = (long long)(machine->max_steps - machine->steps);
+    }
+    machine->fuel = grant;
+    machine->granted = grant;
+}
+
+void bfMachineLimit(BfMachine* machine, unsigned long long max_steps, double timeout) {
+    machine->steps = 0;
+    machine->max_steps = max_steps;
+    machine->deadline = (timeout > 0) ? clockSeconds() + timeout : 0;
+    grantFuel(machine);
+}
+
+int bfMachineRefuel(BfMachine* machine) {
+    machine->steps += (unsigned long long)(machine->granted - machine->fuel);
+    machine->fuel = 0;
+    machine->granted = 0;
+    if (machine->max_steps > 0 && machine->steps > machine->max_steps) {
+        return BF_ERROR_STEP_LIMIT;
+    }
+    if (machine->deadline > 0 && clockSeconds() >= machine->deadline) {
+        return BF_ERROR_TIMEOUT;
+    }
+    grantFuel(machine);
+    return BF_OK;
+}
+
+int bfOutputInit(BfOutput* output, size_t capacity) {
+    output->flush = NULL;
+    output->context = NULL;
+    output->fixed = 0;
+    output->length = 0;
+    output->capacity = (capacity < 16) ? 16 : capacity;
+    output->data = (unsigned char*)malloc(output->capacity * sizeof(unsigned char));
+    return output->data ? BF_OK : BF_ERROR_MEMORY;
+}
+
+// Garantit la place pour extra octets de plus dans la sortie ; avec une
+// fonction d'écriture, le contenu est d'abord transmis et le tampon vidé.
+// Une destination fixe ne grandit pas : la dépasser est une erreur.
+int bfOutputReserve(BfOutput* output, size_t extra) {
+    if (output->length + extra <= output->capacity) {
+        return BF_OK;
+    }
+    if (output->fixed) {
+        return BF_ERROR_OUTPUT_SIZE;
+    }
+    if (output->flush) {
+        if (output->length > 0 && output->flush(output->context, output->data, output->length) != BF_OK) {
+            return BF_ERROR_WRITE;
+        }
+        output->length = 0;
+        if (extra <= output->capacity) {
+            return BF_OK;
+        }
+    }
+    size_t capacity = output->capacity;
+    while (output->length + extra > capacity) {
+        capacity *= 2;
+    }
+    unsigned char* temp = (unsigned char*)realloc(output->data, capacity * sizeof(unsigned char));
+    if (!temp) {
+        return BF_ERROR_MEMORY;
+    }
+    output->data = temp;
+    output->capacity = capacity;
+    return BF_OK;
+}
+
+// Déplace le pointeur de step en step jusqu'à une cellule nulle ; les pas
+// unitaires utilisent memchr/memrchr. Au-delà de la partie accessible de la
+// bande, toutes les cellules sont nulles.
+static int scanTape(BfMachine* machine, long long step) {
+    const unsigned char* tape = machine->tape;
+    size_t position = machine->pointer;
+    int status;
+    if (step == 1) {
+        const unsigned char* zero = (const unsigned char*)memchr(tape + position, 0, machine->tape_size - position);
+        position = zero ? (size_t)(zero - tape) : machine->tape_size;
+        if ((status = bfTapeReach(machine, position)) != BF_OK) {
+            return status;
+        }
+        machine->pointer = position;
+        return BF_OK;
+    }
+#if defined(__GLIBC__)
+    if (step == -1) {
+        const unsigned char* zero = (const unsigned char*)memrchr(tape, 0, position + 1);
+        if (!zero) {
+            return BF_ERROR_TAPE_LEFT;
+        }
+        machine->pointer = (size_t)(zero - tape);
+        return BF_OK;
+    }
+#endif
+    while (tape[position] != 0) {
+        position += (size_t)step;
+        if (position >= machine->tape_size && (status = bfTapeReach(machine, position)) != BF_OK) {
+            return status;
+        }
+    }
+    machine->pointer = position;
+    return BF_OK;
+}
+
+// Exécute une sortie, une boucle de sortie ou une recherche à la position
+// machine->pointer ; sert aux moteurs pour les instructions peu fréquentes
+int bfStep(BfMachine* machine, const BfInstruction* instruction) {
+    unsigned char* tape = machine->tape;
+    size_t pointer = machine->pointer;
+    BfOutput* output = &machine->output;
+    int status = BF_OK;
+
+    // Le JIT ne contrôle pas les petits déplacements : la position peut être
+    // sortie de la partie accessible de la bande
+    if (pointer >= machine->tape_size && (status = bfTapeReach(machine, pointer)) != BF_OK) {
+        return status;
+    }
+
+    switch (instruction->op) {
+        case OP_OUTPUT: {
+            size_t count = (size_t)instruction->arg;
+            if ((status = bfOutputReserve(output, count)) != BF_OK) {
+                return status;
+            }
+            memset(output->data + output->length, tape[pointer], count);
+            output->length += count;
+            return BF_OK;
+        }
+        case OP_OUTPUT_LOOP: {
+            // Boucle de sortie comptée : une seule écriture en bloc
+            size_t count = (size_t)tape[pointer] * (size_t)instruction->arg;
+            if (count == 0) {
+                return BF_OK;
+            }
+            size_t source = pointer + (size_t)(long long)instruction->offset;
+            if (source >= machine->tape_size && (status = bfTapeReach(machine, source)) != BF_OK) {
+                return status;
+            }
+            if ((status = bfOutputReserve(output, count)) != BF_OK) {
+                return status;
+            }
+            memset(output->data + output->length, tape[source], count);
+            output->length += count;
+            tape[pointer] = 0;
+            return BF_OK;
+        }
+        case OP_SCAN:
+            return scanTape(machine, instruction->arg);
+        default:
+            return BF_OK;
+    }
+}
+
+int bfRun(BfMachine* machine, const BfProgram* program) {
+    const BfInstruction* code = program->code;
+    unsigned char* tape = machine->tape;
+    size_t pointer = machine->pointer;
+    BfOutput* output = &machine->output;
+    long long fuel = machine->fuel;
+    size_t pc = 0;
+    int status = BF_OK;
+
+    for (;;) {
+        const BfInstruction* instruction = &code[pc];
+        switch (instruction->op) {
+            case OP_ADD:
+                tape[pointer] += (unsigned char)instruction->arg;
+                break;
+            case OP_MOVE: {
+                // Un seul contrôle de bornes pour toute la suite de déplacements ;
+                // un dépassement à gauche fait reboucler target au-delà de tape_size
+                size_t target = pointer + (size_t)instruction->arg;
+                if (target >= machine->tape_size && (status = bfTapeReach(machine, target)) != BF_OK) {
+                    goto done;
+                }
+                pointer = target;
+                break;
+            }
+            case OP_OUTPUT: {
+                size_t count = (size_t)instruction->arg;
+                if (output->length + count > output->capacity
+                    && (status = bfOutputReserve(output, count)) != BF_OK) {
+                    goto done;
+                }
+                if (count == 1) {
+                    output->data[output->length++] = tape[pointer];
+                } else {
+                    memset(output->data + output->length, tape[pointer], count);
+                    output->length += count;
+                }
+                break;
+            }
+            case OP_INPUT:
+                tape[pointer] = 0;
+                break;
+            case OP_JUMP_ZERO:
+                if (tape[pointer] == 0) {
+                    pc = (size_t)instruction->arg;
+                    continue;
+                }
+                break;
+            case OP_JUMP_NONZERO:
+                // Fin de tour : le corps de la boucle est décompté
+                if ((fuel -= (long long)(pc - (size_t)instruction->arg) + 1) < 0) {
+                    machine->fuel = fuel;
+                    if ((status = bfMachineRefuel(machine)) != BF_OK) {
+                        goto done;
+                    }
+                    fuel = machine->fuel;
+                }
+                if (tape[pointer] != 0) {
+                    pc = (size_t)instruction->arg;
+                    continue;
+                }
+                break;
+            case OP_OUTPUT_LOOP:
+                machine->pointer = pointer;
+                if ((status = bfStep(machine, instruction)) != BF_OK) {
+                    goto done;
+                }
+                break;
+            case OP_SET:
+                tape[pointer] = (unsigned char)instruction->arg;
+                break;
+            case OP_MUL_ADD: {
+                unsigned char value = tape[pointer];
+                if (value == 0) {
+                    break;
+                }
+                size_t target = pointer + (size_t)(long long)instruction->offset;
+                if (target >= machine->tape_size && (status = bfTapeReach(machine, target)) != BF_OK) {
+                    goto done;
+                }
+                tape[target] += (unsigned char)(value * instruction->arg);
+                break;
+            }
+            case OP_SCAN:
+                machine->pointer = pointer;
+                if ((status = bfStep(machine, instruction)) != BF_OK) {
+                    goto done;
+                }
+                pointer = machine->pointer;
+                break;
+            case OP_END:
+                goto done;
+        }
+        pc++;
+    }
+
+done:
+    machine->pointer = pointer;
+    machine->fuel = fuel;
+    return status;
+}
+
+#if defined(__GNUC__)
+
+// Chaque gestionnaire se termine par son propre saut indirect vers le suivant,
+// ce qui donne à chaque transition sa propre prédiction. Le code intermédiaire
+// sert tel quel : la table des gestionnaires est indexée par le code d'opération.
+#define DISPATCH() goto *handlers[ip->op]
+#define NEXT() do { ip++; DISPATCH(); } while (0)
+
+int bfRunThreaded(BfMachine* machine, const BfProgram* program) {
+    static const void* const handlers[] = {
+        [OP_ADD] = &&op_add,
+        [OP_MOVE] = &&op_move,
+        [OP_OUTPUT] = &&op_output,
+        [OP_INPUT] = &&op_input,
+        [OP_JUMP_ZERO] = &&op_jump_zero,
+        [OP_JUMP_NONZERO] = &&op_jump_nonzero,
+        [OP_OUTPUT_LOOP] = &&op_step,
+        [OP_SET] = &&op_set,
+        [OP_MUL_ADD] = &&op_mul_add,
+        [OP_SCAN] = &&op_step,
+        [OP_END] = &&op_end,
+    };
+
+    const BfInstruction* code = program->code;
+    unsigned char* tape = machine->tape;
+    size_t tape_size = machine->tape_size;
+    size_t pointer = machine->pointer;
+    BfOutput* output = &machine->output;
+    long long fuel = machine->fuel;
+    const BfInstruction* ip = code;
+    int status = BF_OK;
+
+    DISPATCH();
+
+op_add:
+    tape[pointer] += (unsigned char)ip->arg;
+    NEXT();
+
+op_move: {
+    size_t target = pointer + (size_t)ip->arg;
+    if (target >= tape_size) {
+        if ((status = bfTapeReach(machine, target)) != BF_OK) {
+            goto done;
+        }
+        tape_size = machine->tape_size;
+    }
+    pointer = target;
+    NEXT();
+}
+
+op_output: {
+    size_t count = (size_t)ip->arg;
+    if (output->length + count > output->capacity
+        && (status = bfOutputReserve(output, count)) != BF_OK) {
+        goto done;
+    }
+    if (count == 1) {
+        output->data[output->length++] = tape[pointer];
+    } else {
+        memset(output->data + output->length, tape[pointer], count);
+        output->length += count;
+    }
+    NEXT();
+}
+
+op_input:
+    tape[pointer] = 0;
+    NEXT();
+
+op_jump_zero:
+    if (tape[pointer] == 0) {
+        ip = code + ip->arg;
+        DISPATCH();
+    }
+    NEXT();
+
+op_jump_nonzero:
+    if ((fuel -= (ip - code) - ip->arg + 1) < 0) {
+        machine->fuel = fuel;
+        if ((status = bfMachineRefuel(machine)) != BF_OK) {
+            goto done;
+        }
+        fuel = machine->fuel;
+    }
+    if (tape[pointer] != 0) {
+        ip = code + ip->arg;
+        DISPATCH();
+    }
+    NEXT();
+
+op_set:
+    tape[pointer] = (unsigned char)ip->arg;
+    NEXT();
+
+op_mul_add: {
+    unsigned char value = tape[pointer];
+    if (value != 0) {
+        size_t target = pointer + (size_t)(long long)ip->offset;
+        if (target >= tape_size) {
+            if ((status = bfTapeReach(machine, target)) != BF_OK) {
+                goto done;
+            }
+            tape_size = machine->tape_size;
+        }
+        tape[target] += (unsigned char)(value * ip->arg);
+    }
+    NEXT();
+}
+
+op_step:
+    // Boucles de sortie et recherches : même traitement que l'interprète
+    machine->pointer = pointer;
+    if ((status = bfStep(machine, ip)) != BF_OK) {
+        goto done;
+    }
+    pointer = machine->pointer;
+    tape_size = machine->tape_size;
+    NEXT();
+
+op_end:
+done:
+    machine->pointer = pointer;
+    machine->fuel = fuel;
+    return status;
+}
+
+#else
+
+int bfRunThreaded(BfMachine* machine, const BfProgram* program) {
+    (void)machine;
+    (void)program;
+    return BF_ERROR_UNSUPPORTED;
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stddef.h>
+
+// Instructions du code intermédiaire exécuté à la place du texte Brainfuck
+typedef enum {
+    OP_ADD = 0,       // cellule += arg (modulo 256)
+    OP_MOVE,          // pointeur += arg
+    OP_OUTPUT,        // écrire arg fois la cellule courante
+    OP_INPUT,         // ',' : pas d'entrée, la cellule passe à 0
+    OP_JUMP_ZERO,     // '[' : si la cellule est nulle, aller à l'instruction arg
+    OP_JUMP_NONZERO,  // ']' : si la cellule n'est pas nulle, aller à l'instruction arg
+    OP_OUTPUT_LOOP,   // "[<.>-]" : écrire cellule × arg fois la cellule offset, puis cellule = 0
+    OP_SET,           // "[-]" : cellule = arg
+    OP_MUL_ADD,       // "[->++<]" : cellule offset += cellule × arg
+    OP_SCAN,          // "[>]" : avancer de arg jusqu'à une cellule nulle
+    OP_END
+} BfOpcode;
+
+typedef struct {
+    int op;
+    int offset;     // Décalage de cellule par rapport au pointeur
+    long long arg;  // Répétitions, déplacement ou cible de saut
+} BfInstruction;
+
+// Programme compilé : suites de '+'/'-'/'>'/'<'/'.' regroupées, sauts résolus
+typedef struct {
+    BfInstruction* code;
+    size_t length;
+    size_t capacity;
+} BfProgram;
+
+// Reçoit les octets décodés ; retourne BF_OK ou BF_ERROR_WRITE
+typedef int (*BfWriteCallback)(void* context, const unsigned char* data, size_t length);
+
+// Tampon de sortie : agrandi par doublement, vidé dans flush quand il est
+// plein, ou destination fixe fournie par l'appelant (fixed) qui ne grandit pas
+typedef struct {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+    BfWriteCallback flush;
+    void* context;
+    int fixed;
+} BfOutput;
+
+// Pages inaccessibles de part et d'autre d'une bande réservée par mmap
+#define BF_TAPE_GUARD (1024 * 1024)
+// Déplacement sans contrôle de bornes quand la bande est gardée : plusieurs
+// déplacements proches sans accès à la bande restent dans les pages de garde
+#define BF_TAPE_REACH (BF_TAPE_GUARD / 8)
+
+// Bande et sortie d'une exécution. La bande réservée (tape_limit cellules)
+// n'est accessible que sur ses tape_size premières cellules, agrandies à la
+// demande : tout ce qui est au-delà est encore nul.
+typedef struct {
+    unsigned char* tape;
+    size_t tape_size;
+    size_t tape_limit;
+    size_t pointer;
+    int guarded;  // Bande entourée de BF_TAPE_GUARD octets inaccessibles
+    BfOutput output;
+    // Limites d'exécution : chaque tour de boucle consomme la longueur de son
+    // corps sur fuel, et les limites ne sont contrôlées que quand fuel est épuisé
+    long long fuel;
+    long long granted;             // Valeur de fuel après le dernier contrôle
+    unsigned long long steps;      // Instructions décomptées par les contrôles précédents
+    unsigned long long max_steps;  // 0 : sans limite
+    double deadline;               // Échéance en secondes d'horloge monotone, 0 : sans limite
+} BfMachine;
+
+// Codes de retour de la compilation et de l'exécution
+enum {
+    BF_OK = 0,
+    BF_ERROR_MEMORY,
+    BF_ERROR_UNMATCHED_OPEN,
+    BF_ERROR_UNMATCHED_CLOSE,
+    BF_ERROR_TAPE_LEFT,
+    BF_ERROR_TAPE_RIGHT,
+    BF_ERROR_UNSUPPORTED,
+    BF_ERROR_WRITE,
+    BF_ERROR_OUTPUT_SIZE,
+    BF_ERROR_INVALID_CHAR,
+    BF_ERROR_STEP_LIMIT,
+    BF_ERROR_TIMEOUT,
+    BF_ERROR_CORRUPT
+};
+
+const char* bfErrorMessage(int status);
+
+// Compilation incrémentale : le source peut arriver en morceaux quelconques,
+// les boucles ouvertes restent dans loops jusqu'à leur ']'
+typedef struct {
+    BfProgram program;
+    size_t* loops;
+    size_t depth;
+    size_t loop_capacity;
+} BfCompiler;
+
+void bfCompilerInit(BfCompiler* compiler);
+int bfCompilerFeed(BfCompiler* compiler, const char* source, size_t length);
+// Suite de count commandes identiques, comme lue dans un code compacté
+int bfCompilerFeedRun(BfCompiler* compiler, char command, unsigned long long count);
+int bfCompilerFinish(BfCompiler* compiler);
+void bfCompilerFree(BfCompiler* compiler);
+
+// La bande n'est réservée que par bfTapeInit, au premier programme à exécuter
+int bfMachineInit(BfMachine* machine, size_t output_capacity);
+void bfMachineFree(BfMachine* machine);
+int bfTapeInit(BfMachine* machine);
+int bfTapeReach(BfMachine* machine, size_t position);
+void bfTapeReset(BfMachine* machine);
+// Au plus max_steps instructions et timeout secondes à partir de maintenant
+// (0 : sans limite). bfMachineRefuel est appelée par les moteurs quand fuel
+// devient négatif : BF_ERROR_STEP_LIMIT ou BF_ERROR_TIMEOUT arrêtent l'exécution.
+void bfMachineLimit(BfMachine* machine, unsigned long long max_steps, double timeout);
+int bfMachineRefuel(BfMachine* machine);
+int bfOutputInit(BfOutput* output, size_t capacity);
+int bfOutputReserve(BfOutput* output, size_t extra);
+int bfStep(BfMachine* machine, const BfInstruction* instruction);
+int bfRun(BfMachine* machine, const BfProgram* program);
+
+// Moteur à code enfilé (goto calculé de GCC/Clang) ; BF_ERROR_UNSUPPORTED
+// avec les autres compilateurs
+int bfRunThreaded(BfMachine* machine, const BfProgram* program);
+
+#endif //BYTECODE_H
@@ -0,0 +1,249 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dedup.h"
+
+// Masques des bits de poids fort testés avant et après la taille moyenne : plus
+// exigeant avant (coupure rare), plus facile après (coupure vite trouvée), la
+// taille des morceaux se resserre autour de DEDUP_AVERAGE_CHUNK
+#define DEDUP_MASK_SMALL 0xFFFE000000000000ULL  // 15 bits
+#define DEDUP_MASK_LARGE 0xFFE0000000000000ULL  // 11 bits
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2CA63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static const uint64_t hash_seeds[2] = {0, 0x4252414944454450ULL};
+
+// Valeurs pseudo-aléatoires du hachage Gear, une par octet
+static uint64_t gear[256];
+static int gear_ready = 0;
+
+static void initGear(void) {
+    if (gear_ready) {
+        return;
+    }
+    uint64_t seed = 0x4745415242465A00ULL;
+    for (int i = 0; i < 256; i++) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        gear[i] = z ^ (z >> 31);
+    }
+    gear_ready = 1;
+}
+
+size_t dedupCut(const unsigned char* data, size_t length) {
+    if (length <= DEDUP_MIN_CHUNK) {
+        return length;
+    }
+    initGear();
+    size_t end = (length < DEDUP_MAX_CHUNK) ? length : DEDUP_MAX_CHUNK;
+    size_t normal = (end < DEDUP_AVERAGE_CHUNK) ? end : DEDUP_AVERAGE_CHUNK;
+
+    // Le hachage ne dépend que des 64 derniers octets : chaque octet entré
+    // décale les précédents d'un bit vers le poids fort
+    uint64_t hash = 0;
+    size_t i = DEDUP_MIN_CHUNK;
+    for (; i < normal; i++) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & DEDUP_MASK_SMALL)) {
+            return i + 1;
+        }
+    }
+    for (; i < end; i++) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & DEDUP_MASK_LARGE)) {
+            return i + 1;
+        }
+    }
+    return end;
+}
+
+static inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t load64(const unsigned char* in) {
+    uint64_t value;
+    memcpy(&value, in, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static inline uint32_t load32(const unsigned char* in) {
+    uint32_t value;
+    memcpy(&value, in, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static inline uint64_t hashRound(uint64_t lane, uint64_t input) {
+    lane += input * PRIME64_2;
+    return rotateLeft(lane, 31) * PRIME64_1;
+}
+
+static inline uint64_t mergeRound(uint64_t hash, uint64_t lane) {
+    hash ^= hashRound(0, lane);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+// Bandes de 32 octets : chaque empreinte a ses quatre voies
+static void hashStripes(DedupHash* state, const unsigned char* data, size_t stripes) {
+    uint64_t a0 = state->lanes[0][0], a1 = state->lanes[0][1], a2 = state->lanes[0][2], a3 = state->lanes[0][3];
+    uint64_t b0 = state->lanes[1][0], b1 = state->lanes[1][1], b2 = state->lanes[1][2], b3 = state->lanes[1][3];
+    for (size_t s = 0; s < stripes; s++, data += 32) {
+        uint64_t w0 = load64(data), w1 = load64(data + 8), w2 = load64(data + 16), w3 = load64(data + 24);
+        a0 = hashRound(a0, w0);
+        a1 = hashRound(a1, w1);
+        a2 = hashRound(a2, w2);
+        a3 = hashRound(a3, w3);
+        b0 = hashRound(b0, w0);
+        b1 = hashRound(b1, w1);
+        b2 = hashRound(b2, w2);
+        b3 = hashRound(b3, w3);
+    }
+    state->lanes[0][0] = a0, state->lanes[0][1] = a1, state->lanes[0][2] = a2, state->lanes[0][3] = a3;
+    state->lanes[1][0] = b0, state->lanes[1][1] = b1, state->lanes[1][2] = b2, state->lanes[1][3] = b3;
+}
+
+void dedupHashInit(DedupHash* state) {
+    for (int h = 0; h < 2; h++) {
+        uint64_t seed = hash_seeds[h];
+        state->lanes[h][0] = seed + PRIME64_1 + PRIME64_2;
+        state->lanes[h][1] = seed + PRIME64_2;
+        state->lanes[h][2] = seed;
+        state->lanes[h][3] = seed - PRIME64_1;
+    }
+    state->buffered = 0;
+    state->total = 0;
+}
+
+void dedupHashUpdate(DedupHash* state, const unsigned char* data, size_t length) {
+    state->total += length;
+    if (state->buffered > 0) {
+        size_t part = 32 - state->buffered;
+        if (part > length) {
+            part = length;
+        }
+        memcpy(state->stripe + state->buffered, data, part);
+        state->buffered += part;
+        data += part;
+        length -= part;
+        if (state->buffered < 32) {
+            return;
+        }
+        hashStripes(state, state->stripe, 1);
+        state->buffered = 0;
+    }
+    hashStripes(state, data, length / 32);
+    state->buffered = length % 32;
+    memcpy(state->stripe, data + length - state->buffered, state->buffered);
+}
+
+void dedupHashFinal(const DedupHash* state, uint64_t hash[2]) {
+    for (int h = 0; h < 2; h++) {
+        const uint64_t* lanes = state->lanes[h];
+        uint64_t value;
+        if (state->total >= 32) {
+            value = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) +
+                    rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+            for (int l = 0; l < 4; l++) {
+                value = mergeRound(value, lanes[l]);
+            }
+        } else {
+            value = hash_seeds[h] + PRIME64_5;
+        }
+        value += state->total;
+
+        const unsigned char* tail = state->stripe;
+        size_t remaining = state->buffered;
+        for (; remaining >= 8; remaining -= 8, tail += 8) {
+            value ^= hashRound(0, load64(tail));
+            value = rotateLeft(value, 27) * PRIME64_1 + PRIME64_4;
+        }
+        if (remaining >= 4) {
+            value ^= (uint64_t)load32(tail) * PRIME64_1;
+            value = rotateLeft(value, 23) * PRIME64_2 + PRIME64_3;
+            remaining -= 4;
+            tail += 4;
+        }
+        for (; remaining > 0; remaining--, tail++) {
+            value ^= *tail * PRIME64_5;
+            value = rotateLeft(value, 11) * PRIME64_1;
+        }
+
+        value ^= value >> 33;
+        value *= PRIME64_2;
+        value ^= value >> 29;
+        value *= PRIME64_3;
+        value ^= value >> 32;
+        hash[h] = value;
+    }
+}
+
+void dedupFingerprint(const unsigned char* data, size_t length, uint64_t hash[2]) {
+    DedupHash state;
+    dedupHashInit(&state);
+    dedupHashUpdate(&state, data, length);
+    dedupHashFinal(&state, hash);
+}
+
+void dedupIndexInit(DedupIndex* index) {
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+// Case de l'empreinte hash et de la taille size, ou case libre où l'ajouter
+static DedupChunk* findSlot(DedupChunk* slots, size_t capacity, const uint64_t hash[2], uint64_t size) {
+    size_t position = (size_t)hash[0] & (capacity - 1);
+    while (slots[position].size != 0 &&
+           (slots[position].size != size || slots[position].hash[0] != hash[0] ||
+            slots[position].hash[1] != hash[1])) {
+        position = (position + 1) & (capacity - 1);
+    }
+    return &slots[position];
+}
+
+const DedupChunk* dedupIndexFind(const DedupIndex* index, const uint64_t hash[2], uint64_t size) {
+    if (index->count == 0) {
+        return NULL;
+    }
+    const DedupChunk* slot = findSlot(index->slots, index->capacity, hash, size);
+    return (slot->size != 0) ? slot : NULL;
+}
+
+int dedupIndexAdd(DedupIndex* index, const DedupChunk* chunk) {
+    if (2 * (index->count + 1) > index->capacity) {
+        size_t capacity = index->capacity ? 2 * index->capacity : 1024;
+        DedupChunk* slots = (DedupChunk*)calloc(capacity, sizeof(DedupChunk));
+        if (!slots) {
+            return -1;
+        }
+        for (size_t i = 0; i < index->capacity; i++) {
+            if (index->slots[i].size != 0) {
+                *findSlot(slots, capacity, index->slots[i].hash, index->slots[i].size) = index->slots[i];
+            }
+        }
+        free(index->slots);
+        index->slots = slots;
+        index->capacity = capacity;
+    }
+    DedupChunk* slot = findSlot(index->slots, index->capacity, chunk->hash, chunk->size);
+    if (slot->size == 0) {
+        index->count++;
+    }
+    *slot = *chunk;
+    return 0;
+}
+
+void dedupIndexFree(DedupIndex* index) {
+    free(index->slots);
+    dedupIndexInit(index);
+}
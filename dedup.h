@@ -0,0 +1,58 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Découpage défini par le contenu (FastCDC) : une coupure tombe là où un
+// hachage roulant des derniers octets (Gear) a ses bits de poids fort nuls.
+// Une insertion ou une suppression ne déplace que les coupures voisines ; les
+// morceaux suivants retrouvent les mêmes limites et la même empreinte.
+#define DEDUP_MIN_CHUNK (2 * 1024)
+#define DEDUP_AVERAGE_CHUNK (8 * 1024)
+#define DEDUP_MAX_CHUNK (64 * 1024)
+
+// Longueur du morceau qui commence data ; length est tout ce qui est disponible,
+// le morceau entier quand il fait moins de DEDUP_MAX_CHUNK octets
+size_t dedupCut(const unsigned char* data, size_t length);
+
+// Empreinte de 128 bits (deux XXH64 de graines différentes calculés ensemble),
+// sur des données arrivant en morceaux quelconques
+typedef struct {
+    uint64_t lanes[2][4];
+    unsigned char stripe[32];  // Octets en attente d'une bande complète
+    size_t buffered;
+    uint64_t total;
+} DedupHash;
+
+void dedupHashInit(DedupHash* state);
+void dedupHashUpdate(DedupHash* state, const unsigned char* data, size_t length);
+void dedupHashFinal(const DedupHash* state, uint64_t hash[2]);
+void dedupFingerprint(const unsigned char* data, size_t length, uint64_t hash[2]);
+
+// Code déjà écrit, retrouvé par l'empreinte et la taille des données
+typedef struct {
+    uint64_t hash[2];
+    uint64_t size;         // 0 : case libre
+    off_t code_offset;     // Position du code dans l'archive
+    uint64_t code_length;
+    size_t source;         // Fichier où les données ont été lues en premier
+    uint64_t source_offset;
+} DedupChunk;
+
+// Table à adressage ouvert, agrandie à moitié pleine
+typedef struct {
+    DedupChunk* slots;
+    size_t capacity;
+    size_t count;
+} DedupIndex;
+
+void dedupIndexInit(DedupIndex* index);
+// NULL si aucun code n'a cette empreinte et cette taille
+const DedupChunk* dedupIndexFind(const DedupIndex* index, const uint64_t hash[2], uint64_t size);
+// -1 si la mémoire manque
+int dedupIndexAdd(DedupIndex* index, const DedupChunk* chunk);
+void dedupIndexFree(DedupIndex* index);
+
+#endif //DEDUP_H
@@ -0,0 +1,453 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "huffman.h"
+
+#define HUFFMAN_TABLE_SIZE (1 << HUFFMAN_MAX_BITS)
+// Longueurs des codes (256 demi-octets) et tailles de trois flux
+#define HUFFMAN_TABLES_SIZE (128 + 4 * (HUFFMAN_STREAMS - 1))
+
+enum {
+    HUFFMAN_STORED = 0,
+    HUFFMAN_CODED
+};
+
+static void putLittleEndian(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittleEndian(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static inline uint64_t loadLittleEndian64(const unsigned char* in) {
+    uint64_t value;
+    memcpy(&value, in, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static int compareWeights(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Longueurs des codes de Huffman des octets présents. Au-delà de
+// HUFFMAN_MAX_BITS, les fréquences sont divisées par deux et l'arbre refait :
+// il s'aplatit à chaque tour, jusqu'à l'équilibre quand toutes valent 1.
+static void buildLengths(const size_t* counts, unsigned char* lengths) {
+    uint64_t weights[2 * 256];
+    int parents[2 * 256];
+    unsigned char depths[2 * 256];
+    size_t frequencies[256];
+    memcpy(frequencies, counts, sizeof(frequencies));
+
+    for (;;) {
+        // Feuilles triées par fréquence, le symbole dans l'octet de poids faible
+        int leaves = 0;
+        for (int s = 0; s < 256; s++) {
+            if (frequencies[s] > 0) {
+                weights[leaves++] = (uint64_t)frequencies[s] << 8 | (uint64_t)s;
+            }
+        }
+        memset(lengths, 0, 256);
+        if (leaves == 1) {
+            lengths[weights[0] & 255] = 1;
+            return;
+        }
+        qsort(weights, (size_t)leaves, sizeof(uint64_t), compareWeights);
+        int symbols[256];
+        for (int i = 0; i < leaves; i++) {
+            symbols[i] = (int)(weights[i] & 255);
+            weights[i] >>= 8;
+        }
+
+        // Deux files : les feuilles triées, et les nœuds créés dans l'ordre
+        // croissant de leur poids
+        int leaf = 0;
+        int node = leaves;
+        int root = 2 * leaves - 2;
+        for (int next = leaves; next <= root; next++) {
+            int pair[2];
+            for (int k = 0; k < 2; k++) {
+                if (leaf < leaves && (node >= next || weights[leaf] <= weights[node])) {
+                    pair[k] = leaf++;
+                } else {
+                    pair[k] = node++;
+                }
+            }
+            weights[next] = weights[pair[0]] + weights[pair[1]];
+            parents[pair[0]] = next;
+            parents[pair[1]] = next;
+        }
+
+        int longest = 0;
+        depths[root] = 0;
+        for (int i = root - 1; i >= 0; i--) {
+            depths[i] = (unsigned char)(depths[parents[i]] + 1);
+            if (i < leaves && depths[i] > longest) {
+                longest = depths[i];
+            }
+        }
+        if (longest <= HUFFMAN_MAX_BITS) {
+            for (int i = 0; i < leaves; i++) {
+                lengths[symbols[i]] = depths[i];
+            }
+            return;
+        }
+        for (int s = 0; s < 256; s++) {
+            frequencies[s] = (frequencies[s] + 1) / 2;
+        }
+    }
+}
+
+// Codes canoniques, bits inversés : le premier bit lu est celui de poids faible.
+// Retourne la place occupée dans une table de HUFFMAN_TABLE_SIZE entrées, ou
+// -1 si les longueurs ne forment pas un code préfixe.
+static int buildCodes(const unsigned char* lengths, unsigned short* codes) {
+    int count[HUFFMAN_MAX_BITS + 1] = {0};
+    unsigned int next[HUFFMAN_MAX_BITS + 1];
+    unsigned int space = 0;
+    for (int s = 0; s < 256; s++) {
+        if (lengths[s] > HUFFMAN_MAX_BITS) {
+            return -1;
+        }
+        if (lengths[s] > 0) {
+            count[lengths[s]]++;
+            space += HUFFMAN_TABLE_SIZE >> lengths[s];
+        }
+    }
+    if (space > HUFFMAN_TABLE_SIZE) {
+        return -1;
+    }
+    unsigned int code = 0;
+    for (int bits = 1; bits <= HUFFMAN_MAX_BITS; bits++) {
+        code = (code + (unsigned int)count[bits - 1]) << 1;
+        next[bits] = code;
+    }
+    for (int s = 0; s < 256; s++) {
+        int bits = lengths[s];
+        if (bits == 0) {
+            continue;
+        }
+        unsigned int value = next[bits]++;
+        unsigned int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((value >> b) & 1) << (bits - 1 - b);
+        }
+        codes[s] = (unsigned short)reversed;
+    }
+    return (int)space;
+}
+
+size_t huffmanEncodeBlock(const unsigned char* data, size_t length, unsigned char* out) {
+    // Un histogramme par flux : la taille de chaque flux s'en déduit
+    size_t stream_counts[HUFFMAN_STREAMS][256] = {{0}};
+    for (size_t i = 0; i < length; i++) {
+        stream_counts[i % HUFFMAN_STREAMS][data[i]]++;
+    }
+    size_t counts[256];
+    for (int s = 0; s < 256; s++) {
+        counts[s] = 0;
+        for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+            counts[s] += stream_counts[k][s];
+        }
+    }
+
+    unsigned char lengths[256];
+    unsigned short codes[256];
+    size_t bits[HUFFMAN_STREAMS] = {0};
+    size_t coded_length = length;
+    if (length > 0) {
+        buildLengths(counts, lengths);
+        buildCodes(lengths, codes);
+        for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+            for (int s = 0; s < 256; s++) {
+                bits[k] += stream_counts[k][s] * lengths[s];
+            }
+        }
+        coded_length = HUFFMAN_TABLES_SIZE;
+        for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+            coded_length += (bits[k] + 7) / 8;
+        }
+    }
+
+    // Bloc sans gain : recopié
+    if (coded_length >= length) {
+        out[0] = HUFFMAN_STORED;
+        putLittleEndian(out + 1, length, 4);
+        putLittleEndian(out + 5, length, 4);
+        memcpy(out + HUFFMAN_HEADER_SIZE, data, length);
+        return HUFFMAN_BOUND(length);
+    }
+
+    out[0] = HUFFMAN_CODED;
+    putLittleEndian(out + 1, length, 4);
+    putLittleEndian(out + 5, coded_length, 4);
+    unsigned char* p = out + HUFFMAN_HEADER_SIZE;
+    for (int s = 0; s < 256; s += 2) {
+        *p++ = (unsigned char)(lengths[s] | lengths[s + 1] << 4);
+    }
+    for (int k = 0; k < HUFFMAN_STREAMS - 1; k++) {
+        putLittleEndian(p, (bits[k] + 7) / 8, 4);
+        p += 4;
+    }
+    for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+        uint64_t accumulator = 0;
+        int count = 0;
+        for (size_t i = (size_t)k; i < length; i += HUFFMAN_STREAMS) {
+            accumulator |= (uint64_t)codes[data[i]] << count;
+            count += lengths[data[i]];
+            if (count >= 32) {
+                putLittleEndian(p, accumulator, 4);
+                p += 4;
+                accumulator >>= 32;
+                count -= 32;
+            }
+        }
+        for (; count > 0; count -= 8) {
+            *p++ = (unsigned char)accumulator;
+            accumulator >>= 8;
+        }
+    }
+    return HUFFMAN_HEADER_SIZE + coded_length;
+}
+
+// Flux de bits d'un bloc ; position peut dépasser size, les octets au-delà
+// valant 0, ce que la vérification finale détecte
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t position;
+    uint64_t bits;
+    int count;
+} BitReader;
+
+// Au moins 56 bits disponibles
+static inline void refillBits(BitReader* reader) {
+    if (reader->position + 8 <= reader->size) {
+        uint64_t word = loadLittleEndian64(reader->data + reader->position);
+        reader->bits |= word << reader->count;
+        reader->position += (size_t)((63 - reader->count) >> 3);
+        reader->count |= 56;
+        return;
+    }
+    while (reader->count <= 56) {
+        uint64_t byte = (reader->position < reader->size) ? reader->data[reader->position] : 0;
+        reader->bits |= byte << reader->count;
+        reader->position++;
+        reader->count += 8;
+    }
+}
+
+// Symbole suivant du flux, qui doit disposer d'au moins HUFFMAN_MAX_BITS bits
+static inline unsigned char decodeSymbol(const unsigned short* table, BitReader* reader) {
+    unsigned int entry = table[reader->bits & (HUFFMAN_TABLE_SIZE - 1)];
+    int bits = (int)(entry & 15);
+    reader->bits >>= bits;
+    reader->count -= bits;
+    return (unsigned char)(entry >> 4);
+}
+
+static int decodeBlock(const unsigned char* block, unsigned char* out) {
+    size_t raw_length = (size_t)getLittleEndian(block + 1, 4);
+    size_t coded_length = (size_t)getLittleEndian(block + 5, 4);
+    const unsigned char* coded = block + HUFFMAN_HEADER_SIZE;
+    if (block[0] == HUFFMAN_STORED) {
+        memcpy(out, coded, raw_length);
+        return BF_OK;
+    }
+    if (coded_length < HUFFMAN_TABLES_SIZE) {
+        return BF_ERROR_CORRUPT;
+    }
+
+    // Table indexée par les HUFFMAN_MAX_BITS prochains bits : symbole et longueur
+    // du code. Le code doit être complet, toute suite de bits est alors décodable
+    // sans vérification ; un symbole seul (code d'un bit) occupe toute la table.
+    unsigned char lengths[256];
+    unsigned short codes[256];
+    int symbols = 0;
+    for (int s = 0; s < 256; s += 2) {
+        lengths[s] = coded[s / 2] & 15;
+        lengths[s + 1] = coded[s / 2] >> 4;
+        symbols += (lengths[s] > 0) + (lengths[s + 1] > 0);
+    }
+    int space = buildCodes(lengths, codes);
+    if (space != HUFFMAN_TABLE_SIZE && !(symbols == 1 && space == HUFFMAN_TABLE_SIZE / 2)) {
+        return BF_ERROR_CORRUPT;
+    }
+    unsigned short table[HUFFMAN_TABLE_SIZE];
+    for (int s = 0; s < 256; s++) {
+        if (lengths[s] > 0) {
+            unsigned int step = (symbols == 1) ? 1 : 1u << lengths[s];
+            for (unsigned int j = (symbols == 1) ? 0 : codes[s]; j < HUFFMAN_TABLE_SIZE; j += step) {
+                table[j] = (unsigned short)(s << 4 | lengths[s]);
+            }
+        }
+    }
+
+    BitReader streams[HUFFMAN_STREAMS];
+    size_t offset = HUFFMAN_TABLES_SIZE;
+    for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t size = coded_length - offset;
+        if (k < HUFFMAN_STREAMS - 1) {
+            size = (size_t)getLittleEndian(coded + 128 + 4 * k, 4);
+            if (size > coded_length - offset) {
+                return BF_ERROR_CORRUPT;
+            }
+        }
+        BitReader stream = {coded + offset, size, 0, 0, 0};
+        streams[k] = stream;
+        offset += size;
+    }
+
+    // Quatre symboles par flux et par tour : 4 * HUFFMAN_MAX_BITS bits tiennent
+    // dans les 56 garantis par un seul rechargement. Les flux sont copiés dans
+    // des variables locales pour rester dans les registres.
+    size_t i = 0;
+    BitReader s0 = streams[0];
+    BitReader s1 = streams[1];
+    BitReader s2 = streams[2];
+    BitReader s3 = streams[3];
+    while (i + 4 * HUFFMAN_STREAMS <= raw_length && s0.position + 8 <= s0.size && s1.position + 8 <= s1.size
+           && s2.position + 8 <= s2.size && s3.position + 8 <= s3.size) {
+        refillBits(&s0);
+        refillBits(&s1);
+        refillBits(&s2);
+        refillBits(&s3);
+        for (int round = 0; round < 4; round++) {
+            out[i] = decodeSymbol(table, &s0);
+            out[i + 1] = decodeSymbol(table, &s1);
+            out[i + 2] = decodeSymbol(table, &s2);
+            out[i + 3] = decodeSymbol(table, &s3);
+            i += 4;
+        }
+    }
+    streams[0] = s0;
+    streams[1] = s1;
+    streams[2] = s2;
+    streams[3] = s3;
+    for (; i < raw_length; i++) {
+        BitReader* stream = &streams[i % HUFFMAN_STREAMS];
+        if (stream->count < HUFFMAN_MAX_BITS) {
+            refillBits(stream);
+        }
+        out[i] = decodeSymbol(table, stream);
+    }
+
+    // Aucun flux ne doit avoir été lu au-delà de sa fin
+    for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+        if (streams[k].position * 8 - (size_t)streams[k].count > streams[k].size * 8) {
+            return BF_ERROR_CORRUPT;
+        }
+    }
+    return BF_OK;
+}
+
+// Taille totale du bloc dont l'en-tête est à block, 0 s'il est invalide. Un
+// bloc valide dépasse toujours son en-tête : un bloc codé contient au moins
+// ses tables.
+static size_t blockSize(const unsigned char* block) {
+    size_t raw_length = (size_t)getLittleEndian(block + 1, 4);
+    size_t coded_length = (size_t)getLittleEndian(block + 5, 4);
+    if (block[0] > HUFFMAN_CODED || raw_length == 0 || raw_length > HUFFMAN_BLOCK_SIZE ||
+        coded_length > raw_length || (block[0] == HUFFMAN_STORED && coded_length != raw_length) ||
+        (block[0] == HUFFMAN_CODED && coded_length < HUFFMAN_TABLES_SIZE)) {
+        return 0;
+    }
+    return HUFFMAN_HEADER_SIZE + coded_length;
+}
+
+int huffmanReaderInit(HuffmanReader* reader) {
+    reader->pending = (unsigned char*)malloc(HUFFMAN_BOUND(HUFFMAN_BLOCK_SIZE));
+    reader->block = (unsigned char*)malloc(HUFFMAN_BLOCK_SIZE);
+    reader->pending_length = 0;
+    if (!reader->pending || !reader->block) {
+        huffmanReaderFree(reader);
+        return BF_ERROR_MEMORY;
+    }
+    return BF_OK;
+}
+
+void huffmanReaderReset(HuffmanReader* reader) {
+    reader->pending_length = 0;
+}
+
+static int emitBlock(HuffmanReader* reader, const unsigned char* block, BfWriteCallback write, void* context) {
+    int status = decodeBlock(block, reader->block);
+    if (status != BF_OK) {
+        return status;
+    }
+    return write(context, reader->block, (size_t)getLittleEndian(block + 1, 4));
+}
+
+int huffmanReaderFeed(HuffmanReader* reader, const unsigned char* data, size_t length,
+                      BfWriteCallback write, void* context) {
+    size_t position = 0;
+    while (position < length) {
+        int status;
+        // Blocs entiers dans le morceau : décodés sur place
+        if (reader->pending_length == 0 && length - position >= HUFFMAN_HEADER_SIZE) {
+            size_t size = blockSize(data + position);
+            if (size == 0) {
+                return BF_ERROR_CORRUPT;
+            }
+            if (length - position >= size) {
+                if ((status = emitBlock(reader, data + position, write, context)) != BF_OK) {
+                    return status;
+                }
+                position += size;
+                continue;
+            }
+        }
+
+        // Sinon le bloc est complété dans pending : d'abord son en-tête, puis le
+        // reste. pending_length reste inférieur à la taille du bloc : chaque tour
+        // avance d'au moins un octet.
+        size_t size = HUFFMAN_HEADER_SIZE;
+        if (reader->pending_length >= HUFFMAN_HEADER_SIZE && (size = blockSize(reader->pending)) == 0) {
+            return BF_ERROR_CORRUPT;
+        }
+        size_t part = size - reader->pending_length;
+        if (part > length - position) {
+            part = length - position;
+        }
+        memcpy(reader->pending + reader->pending_length, data + position, part);
+        reader->pending_length += part;
+        position += part;
+        if (reader->pending_length < HUFFMAN_HEADER_SIZE) {
+            continue;
+        }
+        // En-tête complet : le bloc est émis dès qu'il est entier
+        if ((size = blockSize(reader->pending)) == 0) {
+            return BF_ERROR_CORRUPT;
+        }
+        if (reader->pending_length == size) {
+            if ((status = emitBlock(reader, reader->pending, write, context)) != BF_OK) {
+                return status;
+            }
+            reader->pending_length = 0;
+        }
+    }
+    return BF_OK;
+}
+
+int huffmanReaderFinish(const HuffmanReader* reader) {
+    return (reader->pending_length == 0) ? BF_OK : BF_ERROR_CORRUPT;
+}
+
+void huffmanReaderFree(HuffmanReader* reader) {
+    free(reader->pending);
+    free(reader->block);
+    reader->pending = NULL;
+    reader->block = NULL;
+}
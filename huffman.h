@@ -0,0 +1,43 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <stddef.h>
+#include "bytecode.h"
+
+// Codage entropique du code compacté (bfPack), par blocs indépendants :
+//   en-tête : mode (u8), raw_length (u32), coded_length (u32), puis coded_length octets
+//   mode 0  : octets recopiés tels quels (bloc que le codage n'aurait pas réduit)
+//   mode 1  : longueurs des codes de Huffman canoniques (256 demi-octets), tailles
+//             des trois premiers flux (u32), puis les HUFFMAN_STREAMS flux de bits ;
+//             l'octet i du bloc est dans le flux i % HUFFMAN_STREAMS
+// Les flux entrelacés se décodent ensemble : les lectures de table de l'un
+// n'attendent pas celles des autres.
+#define HUFFMAN_BLOCK_SIZE (128 * 1024)
+#define HUFFMAN_MAX_BITS 12
+#define HUFFMAN_STREAMS 4
+#define HUFFMAN_HEADER_SIZE 9
+// Taille maximale d'un bloc codé de length octets, en-tête compris
+#define HUFFMAN_BOUND(length) (HUFFMAN_HEADER_SIZE + (length))
+
+// Code un bloc de length octets (au plus HUFFMAN_BLOCK_SIZE) dans out ; retourne
+// la taille écrite
+size_t huffmanEncodeBlock(const unsigned char* data, size_t length, unsigned char* out);
+
+// Lecture de blocs codés arrivant en morceaux quelconques
+typedef struct {
+    unsigned char* pending;  // Bloc incomplet, complété au morceau suivant
+    size_t pending_length;
+    unsigned char* block;    // Bloc décodé, HUFFMAN_BLOCK_SIZE octets
+} HuffmanReader;
+
+int huffmanReaderInit(HuffmanReader* reader);
+void huffmanReaderReset(HuffmanReader* reader);
+// Décode les blocs complets et donne leur contenu à write ; BF_ERROR_CORRUPT
+// si un bloc est incohérent
+int huffmanReaderFeed(HuffmanReader* reader, const unsigned char* data, size_t length,
+                      BfWriteCallback write, void* context);
+// BF_ERROR_CORRUPT si le code s'arrête au milieu d'un bloc
+int huffmanReaderFinish(const HuffmanReader* reader);
+void huffmanReaderFree(HuffmanReader* reader);
+
+#endif //HUFFMAN_H
@@ -0,0 +1,434 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "jit.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+
+#include <sys/mman.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <pthread.h>
+
+// Taille maximale du code natif d'une instruction
+#define JIT_MAX_INSTRUCTION_SIZE 128
+
+// Cibles de saut après celles des instructions
+#define LABEL_LEFT 0   // Dépassement de la mémoire à gauche
+#define LABEL_RIGHT 1  // Dépassement de la mémoire à droite
+#define LABEL_EXIT 2   // Sortie, code de retour dans eax
+#define LABEL_OUTPUT 3 // Sous-programme d'écriture quand le tampon est plein
+#define LABEL_FUEL 4   // Sous-programme de contrôle des limites quand fuel est épuisé
+#define LABEL_COUNT 5
+
+// Saut rel32 à compléter une fois toutes les positions connues
+typedef struct {
+    size_t position;
+    size_t label;
+} JitFixup;
+
+typedef struct {
+    unsigned char* code;
+    size_t length;
+    size_t capacity;  // Taille réservée : au plus JIT_MAX_INSTRUCTION_SIZE par instruction
+    size_t* labels;  // Position de chaque instruction, puis des LABEL_COUNT sorties
+    size_t label_base;
+    JitFixup* fixups;
+    size_t fixup_count;
+    size_t fixup_capacity;
+    int guarded;  // Bande gardée : les déplacements proches ne sont pas contrôlés
+} JitBuffer;
+
+// Registres du code natif :
+//   rbx = cellule courante, r12 = BfMachine*, r13 = début de bande, r14 = fin de la réservation,
+//   r15 = fuel
+typedef int (*JitEntry)(BfMachine* machine, unsigned char* cell, unsigned char* tape, unsigned char* tape_end);
+
+// Exécution en cours sur ce thread : un accès au-delà de la partie accessible
+// de la bande l'agrandit, un accès aux pages de garde devient
+// BF_ERROR_TAPE_LEFT ou BF_ERROR_TAPE_RIGHT au lieu d'arrêter le processus
+typedef struct {
+    sigjmp_buf jump;
+    BfMachine* machine;
+} JitGuard;
+
+static _Thread_local JitGuard* active_guard = NULL;
+static struct sigaction previous_action;
+static int handler_installed = 0;
+static pthread_mutex_t handler_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void onFault(int signal, siginfo_t* info, void* context) {
+    (void)signal;
+    (void)context;
+    JitGuard* guard = active_guard;
+    if (guard) {
+        const unsigned char* address = (const unsigned char*)info->si_addr;
+        const unsigned char* tape = guard->machine->tape;
+        const unsigned char* tape_end = tape + guard->machine->tape_limit;
+        int outside = address < tape || address >= tape + guard->machine->tape_size;
+        if (outside && address >= tape - BF_TAPE_GUARD && address < tape_end + BF_TAPE_GUARD) {
+            // L'instruction fautive est réexécutée une fois la bande agrandie
+            int status = bfTapeReach(guard->machine, (size_t)(address - tape));
+            if (status == BF_OK) {
+                return;
+            }
+            siglongjmp(guard->jump, status);
+        }
+    }
+
+    // Faute étrangère : l'instruction est réexécutée avec le gestionnaire précédent
+    sigaction(SIGSEGV, &previous_action, NULL);
+    __atomic_store_n(&handler_installed, 0, __ATOMIC_RELEASE);
+}
+
+// Plusieurs fils peuvent lancer du code natif en même temps : aucun ne doit
+// s'exécuter avant que le gestionnaire soit réellement en place
+static void installFaultHandler(void) {
+    if (__atomic_load_n(&handler_installed, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&handler_lock);
+    if (!handler_installed) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = onFault;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &previous_action);
+        __atomic_store_n(&handler_installed, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&handler_lock);
+}
+
+static void emitBytes(JitBuffer* buffer, const char* bytes, size_t count) {
+    memcpy(buffer->code + buffer->length, bytes, count);
+    buffer->length += count;
+}
+
+static void emit32(JitBuffer* buffer, int value) {
+    memcpy(buffer->code + buffer->length, &value, 4);
+    buffer->length += 4;
+}
+
+static void emit64(JitBuffer* buffer, unsigned long long value) {
+    memcpy(buffer->code + buffer->length, &value, 8);
+    buffer->length += 8;
+}
+
+// Émet un saut rel32 (opcode sur un ou deux octets) vers label
+static int emitJump(JitBuffer* buffer, const char* opcode, size_t opcode_length, size_t label) {
+    if (buffer->fixup_count >= buffer->fixup_capacity) {
+        size_t capacity = (buffer->fixup_capacity == 0) ? 256 : buffer->fixup_capacity * 2;
+        JitFixup* temp = (JitFixup*)realloc(buffer->fixups, capacity * sizeof(JitFixup));
+        if (!temp) {
+            return BF_ERROR_MEMORY;
+        }
+        buffer->fixups = temp;
+        buffer->fixup_capacity = capacity;
+    }
+    emitBytes(buffer, opcode, opcode_length);
+    buffer->fixups[buffer->fixup_count].position = buffer->length;
+    buffer->fixups[buffer->fixup_count].label = label;
+    buffer->fixup_count++;
+    emit32(buffer, 0);
+    return BF_OK;
+}
+
+// Contrôle de bornes d'un pointeur : compare_start et compare_end codent
+// cmp reg, r13 et cmp reg, r14
+static int emitBoundsCheck(JitBuffer* buffer, const char* compare_start, const char* compare_end) {
+    int status;
+    emitBytes(buffer, compare_start, 3);
+    if ((status = emitJump(buffer, "\x0F\x82", 2, buffer->label_base + LABEL_LEFT)) != BF_OK) {
+        return status;
+    }
+    emitBytes(buffer, compare_end, 3);
+    return emitJump(buffer, "\x0F\x83", 2, buffer->label_base + LABEL_RIGHT);
+}
+
+// Appel de bfStep pour l'instruction : la position est synchronisée avant et
+// relue après, une erreur termine le code natif
+static int emitStep(JitBuffer* buffer, const BfInstruction* instruction) {
+    emitBytes(buffer, "\x48\x89\xDE", 3);          // mov rsi, rbx
+    emitBytes(buffer, "\x4C\x29\xEE", 3);          // sub rsi, r13
+    emitBytes(buffer, "\x49\x89\xB4\x24", 4);      // mov [r12 + pointer], rsi
+    emit32(buffer, (int)offsetof(BfMachine, pointer));
+    emitBytes(buffer, "\x4C\x89\xE7", 3);          // mov rdi, r12
+    emitBytes(buffer, "\x48\xBE", 2);              // mov rsi, instruction
+    emit64(buffer, (unsigned long long)(size_t)instruction);
+    emitBytes(buffer, "\x48\xB8", 2);              // mov rax, bfStep
+    emit64(buffer, (unsigned long long)(size_t)&bfStep);
+    emitBytes(buffer, "\xFF\xD0", 2);              // call rax
+    emitBytes(buffer, "\x85\xC0", 2);              // test eax, eax
+    int status = emitJump(buffer, "\x0F\x85", 2, buffer->label_base + LABEL_EXIT);
+    emitBytes(buffer, "\x49\x8B\x9C\x24", 4);      // mov rbx, [r12 + pointer]
+    emit32(buffer, (int)offsetof(BfMachine, pointer));
+    emitBytes(buffer, "\x4C\x01\xEB", 3);          // add rbx, r13
+    return status;
+}
+
+// Écriture d'un octet en ligne ; le sous-programme commun agrandit le tampon
+// quand il est plein
+static int emitOutputByte(JitBuffer* buffer) {
+    emitBytes(buffer, "\x49\x8B\x84\x24", 4);      // mov rax, [r12 + length]
+    emit32(buffer, (int)offsetof(BfMachine, output.length));
+    emitBytes(buffer, "\x49\x3B\x84\x24", 4);      // cmp rax, [r12 + capacity]
+    emit32(buffer, (int)offsetof(BfMachine, output.capacity));
+    emitBytes(buffer, "\x72\x07", 2);              // jb .fast
+    int status = emitJump(buffer, "\xE8", 1, buffer->label_base + LABEL_OUTPUT);  // call output
+    emitBytes(buffer, "\xEB\x19", 2);              // jmp .done
+    emitBytes(buffer, "\x49\x8B\x8C\x24", 4);      // .fast: mov rcx, [r12 + data]
+    emit32(buffer, (int)offsetof(BfMachine, output.data));
+    emitBytes(buffer, "\x0F\xB6\x13", 3);          // movzx edx, byte [rbx]
+    emitBytes(buffer, "\x88\x14\x01", 3);          // mov [rcx + rax], dl
+    emitBytes(buffer, "\x48\xFF\xC0", 3);          // inc rax
+    emitBytes(buffer, "\x49\x89\x84\x24", 4);      // mov [r12 + length], rax
+    emit32(buffer, (int)offsetof(BfMachine, output.length));
+    return status;                                  // .done
+}
+
+// Fin de tour de boucle : le corps (length instructions) est décompté de r15
+static int emitFuel(JitBuffer* buffer, long long length) {
+    emitBytes(buffer, "\x49\x81\xEF", 3);          // sub r15, imm32
+    emit32(buffer, (int)length);
+    emitBytes(buffer, "\x79\x05", 2);              // jns .done
+    return emitJump(buffer, "\xE8", 1, buffer->label_base + LABEL_FUEL);  // call fuel
+}
+
+static int emitInstruction(JitBuffer* buffer, const BfInstruction* instruction, size_t index) {
+    long long arg = instruction->arg;
+    switch (instruction->op) {
+        case OP_ADD:
+            emitBytes(buffer, "\x80\x03", 2);      // add byte [rbx], imm8
+            buffer->code[buffer->length++] = (unsigned char)arg;
+            return BF_OK;
+        case OP_SET:
+            emitBytes(buffer, "\xC6\x03", 2);      // mov byte [rbx], imm8
+            buffer->code[buffer->length++] = (unsigned char)arg;
+            return BF_OK;
+        case OP_INPUT:
+            emitBytes(buffer, "\xC6\x03\x00", 3);  // mov byte [rbx], 0
+            return BF_OK;
+        case OP_MOVE:
+            // La bande est bien plus petite que 2 Gio : un tel déplacement sort forcément
+            if (arg <= -0x80000000LL || arg >= 0x80000000LL) {
+                return emitJump(buffer, "\xE9", 1, buffer->label_base + ((arg < 0) ? LABEL_LEFT : LABEL_RIGHT));
+            }
+            emitBytes(buffer, "\x48\x81\xC3", 3);  // add rbx, imm32
+            emit32(buffer, (int)arg);
+            // Sur une bande gardée, un accès hors de la partie accessible est traité par onFault
+            if (buffer->guarded && arg >= -BF_TAPE_REACH && arg <= BF_TAPE_REACH) {
+                return BF_OK;
+            }
+            return emitBoundsCheck(buffer, "\x4C\x39\xEB", "\x4C\x39\xF3");
+        case OP_MUL_ADD: {
+            emitBytes(buffer, "\x0F\xB6\x03", 3);  // movzx eax, byte [rbx]
+            emitBytes(buffer, "\x84\xC0", 2);      // test al, al
+            emitBytes(buffer, "\x74", 1);          // jz .skip
+            size_t skip_jump = buffer->length;
+            emitBytes(buffer, "\x00", 1);
+            emitBytes(buffer, "\x48\x8D\x8B", 3);  // lea rcx, [rbx + offset]
+            emit32(buffer, instruction->offset);
+            int status = BF_OK;
+            if (!buffer->guarded || instruction->offset < -BF_TAPE_REACH || instruction->offset > BF_TAPE_REACH) {
+                status = emitBoundsCheck(buffer, "\x4C\x39\xE9", "\x4C\x39\xF1");
+            }
+            emitBytes(buffer, "\x69\xC0", 2);      // imul eax, eax, factor
+            emit32(buffer, (int)(arg & 255));
+            emitBytes(buffer, "\x00\x01", 2);      // add [rcx], al
+            buffer->code[skip_jump] = (unsigned char)(buffer->length - skip_jump - 1);
+            return status;
+        }
+        case OP_JUMP_ZERO:
+            emitBytes(buffer, "\x80\x3B\x00", 3);  // cmp byte [rbx], 0
+            return emitJump(buffer, "\x0F\x84", 2, (size_t)arg);
+        case OP_JUMP_NONZERO: {
+            int status = emitFuel(buffer, (long long)index - arg + 1);
+            if (status != BF_OK) {
+                return status;
+            }
+            emitBytes(buffer, "\x80\x3B\x00", 3);  // cmp byte [rbx], 0
+            return emitJump(buffer, "\x0F\x85", 2, (size_t)arg);
+        }
+        case OP_OUTPUT:
+            if (arg == 1) {
+                return emitOutputByte(buffer);
+            }
+            return emitStep(buffer, instruction);
+        case OP_OUTPUT_LOOP:
+        case OP_SCAN:
+            return emitStep(buffer, instruction);
+        case OP_END:
+            emitBytes(buffer, "\x31\xC0", 2);      // xor eax, eax
+            return emitJump(buffer, "\xE9", 1, buffer->label_base + LABEL_EXIT);
+        default:
+            return BF_ERROR_UNSUPPORTED;
+    }
+}
+
+// Instruction passée à bfStep par le sous-programme d'écriture
+static const BfInstruction output_byte = {OP_OUTPUT, 0, 1};
+
+// Traduit tout le programme dans buffer->code, dimensionné pour le pire cas
+static int compileProgram(JitBuffer* buffer, const BfProgram* program) {
+    int status;
+    buffer->label_base = program->length;
+    buffer->labels = (size_t*)malloc((program->length + LABEL_COUNT) * sizeof(size_t));
+    if (!buffer->labels) {
+        return BF_ERROR_MEMORY;
+    }
+
+    // Prologue : registres préservés, pile alignée sur 16 octets pour les appels
+    emitBytes(buffer, "\x53\x41\x54\x41\x55\x41\x56", 7);  // push rbx, r12, r13, r14
+    emitBytes(buffer, "\x41\x57", 2);                      // push r15
+    emitBytes(buffer, "\x49\x89\xFC", 3);                  // mov r12, rdi
+    emitBytes(buffer, "\x48\x89\xF3", 3);                  // mov rbx, rsi
+    emitBytes(buffer, "\x49\x89\xD5", 3);                  // mov r13, rdx
+    emitBytes(buffer, "\x49\x89\xCE", 3);                  // mov r14, rcx
+    emitBytes(buffer, "\x4D\x8B\xBC\x24", 4);              // mov r15, [r12 + fuel]
+    emit32(buffer, (int)offsetof(BfMachine, fuel));
+
+    for (size_t i = 0; i < program->length; i++) {
+        buffer->labels[i] = buffer->length;
+        if ((status = emitInstruction(buffer, &program->code[i], i)) != BF_OK) {
+            return status;
+        }
+    }
+
+    buffer->labels[buffer->label_base + LABEL_LEFT] = buffer->length;
+    emitBytes(buffer, "\xB8", 1);                          // mov eax, BF_ERROR_TAPE_LEFT
+    emit32(buffer, BF_ERROR_TAPE_LEFT);
+    emitBytes(buffer, "\xEB\x05", 2);                      // jmp .exit
+    buffer->labels[buffer->label_base + LABEL_RIGHT] = buffer->length;
+    emitBytes(buffer, "\xB8", 1);                          // mov eax, BF_ERROR_TAPE_RIGHT
+    emit32(buffer, BF_ERROR_TAPE_RIGHT);
+
+    // Épilogue : la position de la cellule et fuel sont rendus à la machine
+    buffer->labels[buffer->label_base + LABEL_EXIT] = buffer->length;
+    emitBytes(buffer, "\x48\x89\xDA", 3);                  // mov rdx, rbx
+    emitBytes(buffer, "\x4C\x29\xEA", 3);                  // sub rdx, r13
+    emitBytes(buffer, "\x49\x89\x94\x24", 4);              // mov [r12 + pointer], rdx
+    emit32(buffer, (int)offsetof(BfMachine, pointer));
+    emitBytes(buffer, "\x4D\x89\xBC\x24", 4);              // mov [r12 + fuel], r15
+    emit32(buffer, (int)offsetof(BfMachine, fuel));
+    emitBytes(buffer, "\x41\x5F", 2);                      // pop r15
+    emitBytes(buffer, "\x41\x5E\x41\x5D\x41\x5C\x5B\xC3", 8);  // pop r14, r13, r12, rbx ; ret
+
+    // Sous-programme d'écriture : bfStep agrandit le tampon et écrit l'octet.
+    // En cas d'erreur, l'adresse de retour est retirée avant de sortir.
+    buffer->labels[buffer->label_base + LABEL_OUTPUT] = buffer->length;
+    emitBytes(buffer, "\x48\x83\xEC\x08", 4);              // sub rsp, 8
+    emitBytes(buffer, "\x48\x89\xDE", 3);                  // mov rsi, rbx
+    emitBytes(buffer, "\x4C\x29\xEE", 3);                  // sub rsi, r13
+    emitBytes(buffer, "\x49\x89\xB4\x24", 4);              // mov [r12 + pointer], rsi
+    emit32(buffer, (int)offsetof(BfMachine, pointer));
+    emitBytes(buffer, "\x4C\x89\xE7", 3);                  // mov rdi, r12
+    emitBytes(buffer, "\x48\xBE", 2);                      // mov rsi, &output_byte
+    emit64(buffer, (unsigned long long)(size_t)&output_byte);
+    emitBytes(buffer, "\x48\xB8", 2);                      // mov rax, bfStep
+    emit64(buffer, (unsigned long long)(size_t)&bfStep);
+    emitBytes(buffer, "\xFF\xD0", 2);                      // call rax
+    emitBytes(buffer, "\x48\x83\xC4\x08", 4);              // add rsp, 8
+    emitBytes(buffer, "\x85\xC0", 2);                      // test eax, eax
+    emitBytes(buffer, "\x75\x01\xC3", 3);                  // jnz .fail ; ret
+    emitBytes(buffer, "\x48\x83\xC4\x08", 4);              // .fail: add rsp, 8
+    if ((status = emitJump(buffer, "\xE9", 1, buffer->label_base + LABEL_EXIT)) != BF_OK) {
+        return status;
+    }
+
+    // Sous-programme de contrôle des limites : bfMachineRefuel relit l'horloge
+    // et redonne du fuel, ou arrête l'exécution
+    buffer->labels[buffer->label_base + LABEL_FUEL] = buffer->length;
+    emitBytes(buffer, "\x48\x83\xEC\x08", 4);              // sub rsp, 8
+    emitBytes(buffer, "\x4D\x89\xBC\x24", 4);              // mov [r12 + fuel], r15
+    emit32(buffer, (int)offsetof(BfMachine, fuel));
+    emitBytes(buffer, "\x4C\x89\xE7", 3);                  // mov rdi, r12
+    emitBytes(buffer, "\x48\xB8", 2);                      // mov rax, bfMachineRefuel
+    emit64(buffer, (unsigned long long)(size_t)&bfMachineRefuel);
+    emitBytes(buffer, "\xFF\xD0", 2);                      // call rax
+    emitBytes(buffer, "\x4D\x8B\xBC\x24", 4);              // mov r15, [r12 + fuel]
+    emit32(buffer, (int)offsetof(BfMachine, fuel));
+    emitBytes(buffer, "\x48\x83\xC4\x08", 4);              // add rsp, 8
+    emitBytes(buffer, "\x85\xC0", 2);                      // test eax, eax
+    emitBytes(buffer, "\x75\x01\xC3", 3);                  // jnz .fail ; ret
+    emitBytes(buffer, "\x48\x83\xC4\x08", 4);              // .fail: add rsp, 8
+    if ((status = emitJump(buffer, "\xE9", 1, buffer->label_base + LABEL_EXIT)) != BF_OK) {
+        return status;
+    }
+
+    for (size_t i = 0; i < buffer->fixup_count; i++) {
+        const JitFixup* fixup = &buffer->fixups[i];
+        int relative = (int)((long long)buffer->labels[fixup->label] - (long long)(fixup->position + 4));
+        memcpy(buffer->code + fixup->position, &relative, 4);
+    }
+    return BF_OK;
+}
+
+int bfJitRun(BfMachine* machine, const BfProgram* program) {
+    // Sans boucle hors idiomes, chaque instruction ne s'exécute qu'une fois :
+    // la traduction coûterait plus que l'interprétation
+    size_t loops = 0;
+    for (size_t i = 0; i < program->length; i++) {
+        if (program->code[i].op == OP_JUMP_ZERO) {
+            loops++;
+        }
+    }
+    if (loops == 0) {
+        return BF_ERROR_UNSUPPORTED;
+    }
+
+    // Zone réservée pour le pire cas, seules les pages écrites sont allouées
+    size_t capacity = (program->length + 3) * JIT_MAX_INSTRUCTION_SIZE;
+    void* region = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) {
+        return BF_ERROR_UNSUPPORTED;
+    }
+
+    JitBuffer buffer = {0};
+    buffer.code = (unsigned char*)region;
+    buffer.capacity = capacity;
+    buffer.guarded = machine->guarded;
+    int status = compileProgram(&buffer, program);
+    free(buffer.labels);
+    free(buffer.fixups);
+
+    // Écriture puis exécution : la zone n'est jamais à la fois inscriptible et exécutable
+    if (status == BF_OK && mprotect(region, capacity, PROT_READ | PROT_EXEC) != 0) {
+        status = BF_ERROR_UNSUPPORTED;
+    }
+    if (status == BF_OK) {
+        JitEntry entry;
+        memcpy(&entry, &region, sizeof(entry));
+        unsigned char* tape = machine->tape;
+        JitGuard guard;
+        guard.machine = machine;
+        if (machine->guarded) {
+            installFaultHandler();
+        }
+        int fault = sigsetjmp(guard.jump, 1);
+        if (fault == 0) {
+            active_guard = machine->guarded ? &guard : NULL;
+            status = entry(machine, tape + machine->pointer, tape, tape + machine->tape_limit);
+        } else {
+            status = fault;
+        }
+        active_guard = NULL;
+
+        // Un dernier déplacement sans accès peut laisser la position hors de la bande
+        if (status == BF_OK) {
+            status = bfTapeReach(machine, machine->pointer);
+        }
+    }
+    munmap(region, capacity);
+    return status;
+}
+
+#else
+
+int bfJitRun(BfMachine* machine, const BfProgram* program) {
+    (void)machine;
+    (void)program;
+    return BF_ERROR_UNSUPPORTED;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "bytecode.h"
+
+// Traduit le programme en code natif x86-64 puis l'exécute sur la machine.
+// Retourne BF_ERROR_UNSUPPORTED sur les autres plateformes, si la mémoire
+// exécutable est refusée ou si le programme n'a aucune boucle à accélérer :
+// l'appelant se replie alors sur bfRun.
+int bfJitRun(BfMachine* machine, const BfProgram* program);
+
+#endif //JIT_H
@@ -1,27 +1,174 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "zip.h"
 
+static void printUsage(const char* program) {
+    printf("Utilisation :\n");
+    printf("Pour compresser : %s compress [options] archive.bfz chemin1 [chemin2 ...]\n", program);
+    printf("Pour décompresser : %s decompress [options] archive.bfz\n", program);
+    printf("Pour extraire certaines entrées : %s extract [options] archive.bfz chemin1 [chemin2 ...]\n", program);
+    printf("Pour exporter le code Brainfuck en texte : %s export-bf archive.bfz [chemin1 ...]\n", program);
+    printf("Options de compression :\n");
+    printf("  --mode=greedy|table|registers  Algorithme d'encodage (greedy par défaut)\n");
+    printf("  --registers=K                  Nombre de registres du mode registers (1 à %d, %d par défaut)\n",
+           BF_MAX_REGISTERS, BF_DEFAULT_REGISTERS);
+    printf("  --runs                         Boucles de sortie pour les longues suites d'octets identiques\n");
+    printf("  --level N, -1 ... -%d           Niveau d'effort : 1 = glouton, au-delà recherche en faisceau\n",
+           BF_MAX_LEVEL);
+    printf("  --format=v1|v2                 Format d'archive (v2 binaire par défaut, v1 texte)\n");
+    printf("  --payload=packed|huffman|text  Code v2 compacté en suites de commandes (par défaut), compacté puis\n");
+    printf("                                 codé par blocs de Huffman, ou en texte\n");
+    printf("  --dedup                        Découpage selon le contenu (v2) : les morceaux identiques ne sont\n");
+    printf("                                 encodés et écrits qu'une fois\n");
+    printf("Options de décompression et d'extraction :\n");
+    printf("  --engine=threaded|interp|jit   Moteur d'exécution (threaded par défaut, jit : code natif x86-64)\n");
+    printf("  --threads=N                    Décodage des grandes entrées sur N fils (1 à %d, 1 par défaut) ;\n",
+           BF_MAX_THREADS);
+    printf("                                 sans effet sur le code Huffman et les entrées --dedup\n");
+    printf("  --max-steps=N                  Au plus N instructions exécutées par fichier\n");
+    printf("  --timeout=S                    Au plus S secondes de décodage par fichier\n");
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 3) {
-        printf("Utilisation :\n");
-        printf("Pour compresser : %s compress archive.bfz chemin1 [chemin2 ...]\n", argv[0]);
-        printf("Pour décompresser : %s decompress archive.bfz\n", argv[0]);
+        printUsage(argv[0]);
         return 1;
     }
 
     if (strcmp(argv[1], "compress") == 0) {
-        const char* output_filename = argv[2];
-        const char** input_paths = (const char**)&argv[3];
-        int path_count = argc - 3;
+        CompressOptions options = {{BF_MODE_GREEDY, BF_DEFAULT_REGISTERS, 1, 0}, ARCHIVE_VERSION,
+                                   ARCHIVE_PAYLOAD_PACKED, 0};
+        int packed_requested = 0;
+        int arg = 2;
+        while (arg < argc && argv[arg][0] == '-') {
+            const char* level = NULL;
+            if (strcmp(argv[arg], "--level") == 0 && arg + 1 < argc) {
+                level = argv[++arg];
+            } else if (strncmp(argv[arg], "--level=", 8) == 0) {
+                level = argv[arg] + 8;
+            } else if (argv[arg][1] >= '1' && argv[arg][1] <= '9' && argv[arg][2] == '\0') {
+                level = argv[arg] + 1;
+            }
+
+            if (level) {
+                options.encoding.level = atoi(level);
+                if (options.encoding.level < 1 || options.encoding.level > BF_MAX_LEVEL) {
+                    fprintf(stderr, "Erreur : Niveau invalide %s\n", level);
+                    return 1;
+                }
+                // Niveau 1 : algorithme glouton historique, au-delà : recherche de plus en plus large
+                options.encoding.mode = (options.encoding.level == 1) ? BF_MODE_GREEDY : BF_MODE_SEARCH;
+            } else if (strcmp(argv[arg], "--runs") == 0) {
+                options.encoding.runs = 1;
+            } else if (strcmp(argv[arg], "--format=v1") == 0) {
+                options.format = 1;
+            } else if (strcmp(argv[arg], "--format=v2") == 0) {
+                options.format = ARCHIVE_VERSION;
+            } else if (strcmp(argv[arg], "--payload=packed") == 0) {
+                options.payload = ARCHIVE_PAYLOAD_PACKED;
+                packed_requested = 1;
+            } else if (strcmp(argv[arg], "--payload=huffman") == 0) {
+                options.payload = ARCHIVE_PAYLOAD_HUFFMAN;
+                packed_requested = 1;
+            } else if (strcmp(argv[arg], "--payload=text") == 0) {
+                options.payload = ARCHIVE_PAYLOAD_BRAINFUCK;
+                packed_requested = 0;
+            } else if (strcmp(argv[arg], "--dedup") == 0) {
+                options.dedup = 1;
+            } else if (strcmp(argv[arg], "--mode=greedy") == 0) {
+                options.encoding.mode = BF_MODE_GREEDY;
+            } else if (strcmp(argv[arg], "--mode=table") == 0) {
+                options.encoding.mode = BF_MODE_TABLE;
+            } else if (strcmp(argv[arg], "--mode=registers") == 0) {
+                options.encoding.mode = BF_MODE_REGISTERS;
+            } else if (strncmp(argv[arg], "--registers=", 12) == 0) {
+                options.encoding.registers = atoi(argv[arg] + 12);
+                if (options.encoding.registers < 1 || options.encoding.registers > BF_MAX_REGISTERS) {
+                    fprintf(stderr, "Erreur : Nombre de registres invalide %s\n", argv[arg] + 12);
+                    return 1;
+                }
+            } else {
+                fprintf(stderr, "Erreur : Option inconnue %s\n", argv[arg]);
+                return 1;
+            }
+            arg++;
+        }
+        if (arg >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        // Le format texte n'a que du code en texte
+        if (options.format == 1 && packed_requested) {
+            fprintf(stderr, "Erreur : --payload=packed ou huffman demande le format v2\n");
+            return 1;
+        }
+        if (options.format == 1 && options.dedup) {
+            fprintf(stderr, "Erreur : --dedup demande le format v2\n");
+            return 1;
+        }
+
+        const char* output_filename = argv[arg];
+        const char** input_paths = (const char**)&argv[arg + 1];
+        int path_count = argc - arg - 1;
         if (path_count <= 0) {
             fprintf(stderr, "Erreur : Aucun fichier ou dossier spécifié pour la compression\n");
             return 1;
         }
-        return compressFiles(output_filename, input_paths, path_count);
-    } else if (strcmp(argv[1], "decompress") == 0) {
-        const char* input_filename = argv[2];
-        return decompressFile(input_filename);
+        return compressFiles(output_filename, input_paths, path_count, &options);
+    } else if (strcmp(argv[1], "decompress") == 0 || strcmp(argv[1], "extract") == 0) {
+        // Archive non fiable : le code de chaque fichier est vérifié avant d'être exécuté
+        DecompressOptions options = {{BF_ENGINE_THREADED, 1, 0, 0}, 1};
+        int arg = 2;
+        while (arg < argc && argv[arg][0] == '-') {
+            if (strcmp(argv[arg], "--engine=interp") == 0) {
+                options.decoding.engine = BF_ENGINE_INTERP;
+            } else if (strcmp(argv[arg], "--engine=threaded") == 0) {
+                options.decoding.engine = BF_ENGINE_THREADED;
+            } else if (strcmp(argv[arg], "--engine=jit") == 0) {
+                options.decoding.engine = BF_ENGINE_JIT;
+            } else if (strncmp(argv[arg], "--max-steps=", 12) == 0) {
+                char* end;
+                options.decoding.max_steps = strtoull(argv[arg] + 12, &end, 10);
+                if (options.decoding.max_steps == 0 || *end != '\0') {
+                    fprintf(stderr, "Erreur : Nombre d'instructions invalide %s\n", argv[arg] + 12);
+                    return 1;
+                }
+            } else if (strncmp(argv[arg], "--timeout=", 10) == 0) {
+                char* end;
+                options.decoding.timeout = strtod(argv[arg] + 10, &end);
+                if (!(options.decoding.timeout > 0) || *end != '\0') {
+                    fprintf(stderr, "Erreur : Délai invalide %s\n", argv[arg] + 10);
+                    return 1;
+                }
+            } else if (strncmp(argv[arg], "--threads=", 10) == 0) {
+                options.threads = atoi(argv[arg] + 10);
+                if (options.threads < 1 || options.threads > BF_MAX_THREADS) {
+                    fprintf(stderr, "Erreur : Nombre de fils invalide %s\n", argv[arg] + 10);
+                    return 1;
+                }
+            } else {
+                fprintf(stderr, "Erreur : Option inconnue %s\n", argv[arg]);
+                return 1;
+            }
+            arg++;
+        }
+        if (arg >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* input_filename = argv[arg];
+        if (strcmp(argv[1], "extract") == 0) {
+            if (arg + 1 >= argc) {
+                fprintf(stderr, "Erreur : Aucune entrée spécifiée pour l'extraction\n");
+                return 1;
+            }
+            return extractFiles(input_filename, (const char**)&argv[arg + 1], argc - arg - 1, &options);
+        }
+        return decompressFile(input_filename, &options);
+    } else if (strcmp(argv[1], "export-bf") == 0) {
+        return exportBrainfuck(argv[2], (const char**)&argv[3], argc - 3);
     } else {
         fprintf(stderr, "Erreur : Commande inconnue %s\n", argv[1]);
         return 1;
@@ -0,0 +1,76 @@
+// Blocs de Huffman donnés au lecteur en deux morceaux, coupés à chaque
+// position : le décodage ne dépend pas du découpage, et un en-tête invalide
+// est rejeté au lieu de bloquer la lecture
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../huffman.h"
+
+typedef struct {
+    unsigned char data[4096];
+    size_t length;
+} Output;
+
+static int collect(void* context, const unsigned char* data, size_t length) {
+    Output* output = (Output*)context;
+    if (output->length + length > sizeof(output->data)) {
+        return BF_ERROR_WRITE;
+    }
+    memcpy(output->data + output->length, data, length);
+    output->length += length;
+    return BF_OK;
+}
+
+// Donne block au lecteur en deux morceaux coupés à split ; status de la lecture
+static int feedSplit(HuffmanReader* reader, const unsigned char* block, size_t length, size_t split,
+                     Output* output) {
+    huffmanReaderReset(reader);
+    output->length = 0;
+    int status = huffmanReaderFeed(reader, block, split, collect, output);
+    if (status == BF_OK) {
+        status = huffmanReaderFeed(reader, block + split, length - split, collect, output);
+    }
+    return (status == BF_OK) ? huffmanReaderFinish(reader) : status;
+}
+
+int main(void) {
+    HuffmanReader reader;
+    if (huffmanReaderInit(&reader) != BF_OK) {
+        return 1;
+    }
+    int failures = 0;
+
+    // Bloc codé et bloc recopié, suivis d'un second bloc dans le même code
+    unsigned char raw[1000];
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        raw[i] = (unsigned char)((i % 7 == 0) ? 0x0E : i % 3);
+    }
+    unsigned char stored[] = {0, 3, 0, 0, 0, 3, 0, 0, 0, 'a', 'b', 'c'};
+    static unsigned char code[HUFFMAN_BOUND(1000) + sizeof(stored)];
+    size_t length = huffmanEncodeBlock(raw, sizeof(raw), code);
+    memcpy(code + length, stored, sizeof(stored));
+    length += sizeof(stored);
+    Output output;
+    for (size_t split = 0; split <= length; split++) {
+        if (feedSplit(&reader, code, length, split, &output) != BF_OK || output.length != sizeof(raw) + 3 ||
+            memcmp(output.data, raw, sizeof(raw)) != 0 || memcmp(output.data + sizeof(raw), "abc", 3) != 0) {
+            fprintf(stderr, "Bloc valide coupé à %zu mal décodé\n", split);
+            failures++;
+        }
+    }
+
+    // En-tête d'un bloc codé sans tables (coded_length nul)
+    unsigned char empty[16] = {1, 1, 0, 0, 0, 0, 0, 0, 0};
+    for (size_t split = 0; split <= sizeof(empty); split++) {
+        if (feedSplit(&reader, empty, sizeof(empty), split, &output) != BF_ERROR_CORRUPT) {
+            fprintf(stderr, "Bloc sans tables coupé à %zu accepté\n", split);
+            failures++;
+        }
+    }
+
+    huffmanReaderFree(&reader);
+    if (failures == 0) {
+        printf("huffman_split : OK\n");
+    }
+    return failures ? 1 : 0;
+}
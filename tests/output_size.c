@@ -0,0 +1,125 @@
+// Taille enregistrée d'une entrée v2 faussée d'un octet, en plus ou en moins,
+// dans son en-tête et dans la table des matières : decompress et extract
+// doivent la refuser. La petite entrée est écrite au fil du décodage, la
+// grande dépasse une fenêtre de sortie : son fichier extrait est projeté en
+// mémoire et rempli directement par le décodeur.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../zip.h"
+
+#define ENTRY_SIZE (100 * 1024)
+
+static const uint64_t entry_sizes[] = {1000, ENTRY_SIZE};
+
+static unsigned char data[ENTRY_SIZE];
+
+static void store64(unsigned char* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t load64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = value << 8 | in[i];
+    }
+    return value;
+}
+
+// Copie de l'archive source dont l'unique entrée annonce size octets
+static int writeTampered(const unsigned char* archive, size_t length, const char* name, uint64_t size) {
+    unsigned char* copy = (unsigned char*)malloc(length);
+    if (!copy) {
+        return -1;
+    }
+    memcpy(copy, archive, length);
+    store64(copy + ARCHIVE_HEADER_SIZE + 8, size);
+    uint64_t toc = load64(copy + length - ARCHIVE_FOOTER_SIZE);
+    store64(copy + toc + 8, size);
+    FILE* file = fopen(name, "wb");
+    int result = (file && fwrite(copy, 1, length, file) == length) ? 0 : -1;
+    if (file && fclose(file) != 0) {
+        result = -1;
+    }
+    free(copy);
+    return result;
+}
+
+// Vrai si data.bin existe et redonne exactement les size premiers octets de data
+static int restored(size_t size) {
+    static unsigned char check[ENTRY_SIZE + 1];
+    FILE* file = fopen("data.bin", "rb");
+    if (!file) {
+        return 0;
+    }
+    size_t length = fread(check, 1, sizeof(check), file);
+    fclose(file);
+    return length == size && memcmp(check, data, size) == 0;
+}
+
+int main(void) {
+    char directory[] = "/tmp/brainzip_output_size_XXXXXX";
+    if (!mkdtemp(directory) || chdir(directory) != 0) {
+        return 1;
+    }
+    uint32_t state = 12345;
+    for (size_t i = 0; i < ENTRY_SIZE; i++) {
+        state = state * 1103515245 + 12345;
+        data[i] = (unsigned char)(state >> 24) & 0x3F;
+    }
+    const char* inputs[] = {"data.bin"};
+    const char* paths[] = {"data.bin"};
+    CompressOptions compress = {{BF_MODE_GREEDY, BF_DEFAULT_REGISTERS, 1, 0}, ARCHIVE_VERSION, ARCHIVE_PAYLOAD_PACKED, 0};
+    DecompressOptions decompress = {{BF_ENGINE_THREADED, 1, 0, 0}, 1};
+    static unsigned char archive[1 << 20];
+    int failures = 0;
+    for (size_t e = 0; e < sizeof(entry_sizes) / sizeof(entry_sizes[0]); e++) {
+        uint64_t size = entry_sizes[e];
+        FILE* file = fopen("data.bin", "wb");
+        if (!file || fwrite(data, 1, (size_t)size, file) != size || fclose(file) != 0 ||
+            compressFiles("a.bfz", inputs, 1, &compress) != 0) {
+            return 1;
+        }
+        file = fopen("a.bfz", "rb");
+        size_t length = file ? fread(archive, 1, sizeof(archive), file) : 0;
+        if (file) {
+            fclose(file);
+        }
+        if (length == 0 || length == sizeof(archive) || load64(archive + ARCHIVE_HEADER_SIZE + 8) != size) {
+            return 1;
+        }
+
+        const uint64_t sizes[] = {size, size - 1, size + 1};
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            int expected = (sizes[i] == size) ? 0 : -1;
+            if (writeTampered(archive, length, "b.bfz", sizes[i]) != 0) {
+                return 1;
+            }
+            remove("data.bin");
+            int result = decompressFile("b.bfz", &decompress);
+            if (result != expected || (expected == 0 && !restored((size_t)size))) {
+                fprintf(stderr, "decompress, taille %llu pour %llu : %d au lieu de %d\n",
+                        (unsigned long long)sizes[i], (unsigned long long)size, result, expected);
+                failures++;
+            }
+            remove("data.bin");
+            result = extractFiles("b.bfz", paths, 1, &decompress);
+            if (result != expected || (expected == 0 && !restored((size_t)size))) {
+                fprintf(stderr, "extract, taille %llu pour %llu : %d au lieu de %d\n",
+                        (unsigned long long)sizes[i], (unsigned long long)size, result, expected);
+                failures++;
+            }
+        }
+    }
+
+    remove("data.bin");
+    remove("a.bfz");
+    remove("b.bfz");
+    chdir("/");
+    rmdir(directory);
+    printf("output_size : %s\n", failures ? "ÉCHEC" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+// Entrée assez grande pour le décodage sur plusieurs fils : des lignes de
+// texte, dont chaque saut de ligne suivi d'une lettre donne un "[-]" où couper
+// le code. Elle doit être restaurée à l'identique, et refusée si sa taille
+// enregistrée est faussée d'un octet.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../zip.h"
+
+#define ENTRY_SIZE (17 * 1024 * 1024)
+
+static const int payloads[] = {ARCHIVE_PAYLOAD_BRAINFUCK, ARCHIVE_PAYLOAD_PACKED};
+
+static unsigned char* data;
+static unsigned char* check;
+
+static void store64(unsigned char* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t load64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = value << 8 | in[i];
+    }
+    return value;
+}
+
+// Taille de l'unique entrée de l'archive name, dans son en-tête et dans la table des matières
+static int setSize(const char* name, uint64_t size) {
+    FILE* file = fopen(name, "r+b");
+    if (!file) {
+        return -1;
+    }
+    unsigned char field[8];
+    store64(field, size);
+    int result = (fseeko(file, ARCHIVE_HEADER_SIZE + 8, SEEK_SET) == 0 && fwrite(field, 1, 8, file) == 8 &&
+                  fseeko(file, -ARCHIVE_FOOTER_SIZE, SEEK_END) == 0 && fread(field, 1, 8, file) == 8) ? 0 : -1;
+    if (result == 0) {
+        off_t toc = (off_t)load64(field);
+        store64(field, size);
+        result = (fseeko(file, toc + 8, SEEK_SET) == 0 && fwrite(field, 1, 8, file) == 8) ? 0 : -1;
+    }
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+static int writeInput(void) {
+    FILE* file = fopen("data.txt", "wb");
+    if (!file) {
+        return -1;
+    }
+    int result = (fwrite(data, 1, ENTRY_SIZE, file) == ENTRY_SIZE) ? 0 : -1;
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+static int restored(void) {
+    FILE* file = fopen("data.txt", "rb");
+    if (!file) {
+        return 0;
+    }
+    size_t length = fread(check, 1, ENTRY_SIZE + 1, file);
+    fclose(file);
+    return length == ENTRY_SIZE && memcmp(check, data, ENTRY_SIZE) == 0;
+}
+
+int main(void) {
+    char directory[] = "/tmp/brainzip_parallel_decode_XXXXXX";
+    data = (unsigned char*)malloc(ENTRY_SIZE);
+    check = (unsigned char*)malloc(ENTRY_SIZE + 1);
+    if (!data || !check || !mkdtemp(directory) || chdir(directory) != 0) {
+        return 1;
+    }
+    for (size_t i = 0; i < ENTRY_SIZE; i++) {
+        data[i] = (i % 64 == 63) ? '\n' : (unsigned char)('a' + (i / 64 + i % 64) % 26);
+    }
+
+    const char* inputs[] = {"data.txt"};
+    DecompressOptions decompress = {{BF_ENGINE_THREADED, 1, 0, 0}, 4};
+    int failures = 0;
+    for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); p++) {
+        CompressOptions compress = {{BF_MODE_GREEDY, BF_DEFAULT_REGISTERS, 1, 0}, ARCHIVE_VERSION, payloads[p], 0};
+        if (writeInput() != 0 || compressFiles("a.bfz", inputs, 1, &compress) != 0) {
+            return 1;
+        }
+        const uint64_t sizes[] = {ENTRY_SIZE, ENTRY_SIZE - 1, ENTRY_SIZE + 1};
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            int expected = (sizes[i] == ENTRY_SIZE) ? 0 : -1;
+            if (setSize("a.bfz", sizes[i]) != 0) {
+                return 1;
+            }
+            remove("data.txt");
+            int result = decompressFile("a.bfz", &decompress);
+            if (result != expected || (expected == 0 && !restored())) {
+                fprintf(stderr, "code %d, taille %llu : %d au lieu de %d\n", payloads[p],
+                        (unsigned long long)sizes[i], result, expected);
+                failures++;
+            }
+        }
+    }
+
+    remove("data.txt");
+    remove("a.bfz");
+    chdir("/");
+    rmdir(directory);
+    free(data);
+    free(check);
+    printf("parallel_decode : %s\n", failures ? "ÉCHEC" : "OK");
+    return failures ? 1 : 0;
+}
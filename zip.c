@@ -1,33 +1,62 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <time.h>   // Pour les mesures de performance
 #include "zip.h"
 
 #include "brainfuck.h"
+#include "archive.h"
+#include "huffman.h"
+#include "dedup.h"
 
 #define BUFFER_SIZE 8192  // Augmenté pour améliorer les performances d'I/O
 #define PROGRESS_BAR_WIDTH 50
+#define CHUNK_SIZE (64 * 1024)  // Taille des morceaux lus et encodés à la compression
+#define PARALLEL_MIN_SIZE (16 * 1024 * 1024)  // Entrées décodées sur plusieurs fils à partir de cette taille
+#define MAP_SLICE (1024 * 1024)  // Code projeté transmis au décodeur par tranches de cette taille
+#define DEDUP_WINDOW (2 * DEDUP_MAX_CHUNK)  // Données lues d'avance pour trouver la coupure suivante
 
 // Cross-platform mkdir
 #ifdef _WIN32
 #include <direct.h>
 #define MKDIR(dir) _mkdir(dir)
+#define LINK(from, to) (-1)  // Doubles recopiés
 #define PATH_SEPARATOR "\\"
 #else
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #define MKDIR(dir) mkdir(dir, 0755)
+#define LINK(from, to) link(from, to)
 #define PATH_SEPARATOR "/"
+#define MAP_OUTPUT  // Fichiers extraits projetés en mémoire et remplis par le décodeur
 #endif
 
 typedef struct {
     char* path;
     int is_directory;
     size_t size;  // Ajouté pour suivre la taille totale pour la barre de progression
+    off_t code_offset;   // Code de l'entrée dans une archive binaire
+    size_t code_length;  // (size_t)-1 dans une archive texte : code lu jusqu'à "EndFile"
+    int encoding;        // Encodage du code (ARCHIVE_PAYLOAD_*)
+    int flags;           // Options de l'entrée (ARCHIVE_ENTRY_*)
+    dev_t device;        // Identité du fichier source : ses liens physiques ont la même
+    ino_t inode;
+    int link;            // Double d'une entrée précédente (ARCHIVE_LINK_*), -1 sinon
+    size_t link_target;  // Numéro de cette entrée, (size_t)-1 si elle n'est pas dans la liste
 } FileInfo;
 
+// Archive projetée en lecture ; data vaut NULL si elle ne l'est pas
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t released;  // Pages déjà rendues au système avant cette position
+} MappedArchive;
+
 FileInfo* files = NULL;
 size_t file_count = 0;
 size_t file_capacity = 0;
@@ -70,6 +99,7 @@ void collectFiles(const char* base_path, const char* relative_path) {
         files[file_count].path = strdup(relative_path);
         files[file_count].is_directory = 1;
         files[file_count].size = 0;
+        files[file_count].link = -1;
         file_count++;
 
         DIR* dir = opendir(full_path);
@@ -102,12 +132,377 @@ void collectFiles(const char* base_path, const char* relative_path) {
         files[file_count].path = strdup(relative_path);
         files[file_count].is_directory = 0;
         files[file_count].size = st.st_size;
+        files[file_count].device = st.st_dev;
+        files[file_count].inode = st.st_ino;
+        files[file_count].link = -1;
         total_bytes += st.st_size;
         file_count++;
     }
 }
 
-int compressFiles(const char* output_filename, const char** input_paths, int path_count) {
+// Table des matières des entrées de files, dont le code a été écrit
+static int writeToc(FILE* output_file) {
+    ArchiveEntry* entries = (ArchiveEntry*)malloc((file_count ? file_count : 1) * sizeof(ArchiveEntry));
+    const char** paths = (const char**)malloc((file_count ? file_count : 1) * sizeof(char*));
+    int status = -1;
+    if (entries && paths) {
+        for (size_t i = 0; i < file_count; i++) {
+            FileInfo* fi = &files[i];
+            ArchiveEntry entry = {fi->is_directory ? ARCHIVE_DIRECTORY : ARCHIVE_FILE, fi->encoding, fi->flags,
+                                  (uint32_t)strlen(fi->path), fi->size, fi->code_length, fi->code_offset};
+            entries[i] = entry;
+            paths[i] = fi->path;
+        }
+        status = archiveWriteToc(output_file, entries, paths, file_count);
+    }
+    free(entries);
+    free(paths);
+    return status;
+}
+
+// Ajoute length octets de code compacté au bloc en cours (block, suivi de la
+// place du bloc codé) ; chaque bloc plein est codé puis écrit, et le dernier
+// aussi avec flush. Retourne le nombre d'octets écrits.
+static size_t writeHuffman(FILE* output_file, unsigned char* block, size_t* block_length,
+                           const unsigned char* data, size_t length, int flush) {
+    unsigned char* coded = block + HUFFMAN_BLOCK_SIZE;
+    size_t written = 0;
+    while (length > 0 || (flush && *block_length > 0)) {
+        size_t part = HUFFMAN_BLOCK_SIZE - *block_length;
+        if (part > length) {
+            part = length;
+        }
+        memcpy(block + *block_length, data, part);
+        *block_length += part;
+        data += part;
+        length -= part;
+        if (*block_length == HUFFMAN_BLOCK_SIZE || (flush && length == 0)) {
+            size_t size = huffmanEncodeBlock(block, *block_length, coded);
+            fwrite(coded, 1, size, output_file);
+            written += size;
+            *block_length = 0;
+        }
+    }
+    return written;
+}
+
+// Code d'un fichier, ou d'un morceau de fichier, dans l'encodage choisi ; les
+// tampons servent d'un code à l'autre
+typedef struct {
+    int payload;            // ARCHIVE_PAYLOAD_*
+    BfEncoder encoder;
+    BfPacker packer;
+    unsigned char* packed;  // Code compacté avant l'écriture
+    size_t packed_capacity;
+    unsigned char* block;   // Bloc de Huffman en cours, suivi de la place du bloc codé
+    size_t block_length;
+} CodeWriter;
+
+static int initCodeWriter(CodeWriter* writer, const BfEncodeOptions* options, int payload) {
+    writer->payload = payload;
+    writer->packed = NULL;
+    writer->packed_capacity = 0;
+    writer->block = NULL;
+    writer->block_length = 0;
+    if (payload == ARCHIVE_PAYLOAD_HUFFMAN) {
+        writer->block = (unsigned char*)malloc(HUFFMAN_BLOCK_SIZE + HUFFMAN_BOUND(HUFFMAN_BLOCK_SIZE));
+        if (!writer->block) {
+            return -1;
+        }
+    }
+    bfEncoderInit(&writer->encoder, options);
+    return 0;
+}
+
+// Le code suivant repart d'une bande vierge
+static void resetCodeWriter(CodeWriter* writer) {
+    bfEncoderReset(&writer->encoder);
+    bfPackInit(&writer->packer);
+    writer->block_length = 0;
+}
+
+// Encode length octets et écrit leur code ; retourne le nombre d'octets
+// écrits, (size_t)-1 si l'encodage échoue
+static size_t writeCode(CodeWriter* writer, FILE* output_file, const unsigned char* data, size_t length) {
+    size_t bf_length = 0;
+    const char* bf_code = bfEncoderFeed(&writer->encoder, data, length, &bf_length);
+    if (!bf_code) {
+        return (size_t)-1;
+    }
+    if (writer->payload == ARCHIVE_PAYLOAD_BRAINFUCK) {
+        fwrite(bf_code, 1, bf_length, output_file);
+        return bf_length;
+    }
+    if (bf_length + BF_PACKED_MAX_TOKEN > writer->packed_capacity) {
+        unsigned char* temp = (unsigned char*)realloc(writer->packed, bf_length + BF_PACKED_MAX_TOKEN);
+        if (!temp) {
+            return (size_t)-1;
+        }
+        writer->packed = temp;
+        writer->packed_capacity = bf_length + BF_PACKED_MAX_TOKEN;
+    }
+    bf_length = bfPack(&writer->packer, bf_code, bf_length, writer->packed);
+    if (writer->payload == ARCHIVE_PAYLOAD_HUFFMAN) {
+        return writeHuffman(output_file, writer->block, &writer->block_length, writer->packed, bf_length, 0);
+    }
+    fwrite(writer->packed, 1, bf_length, output_file);
+    return bf_length;
+}
+
+// Dernière suite de commandes, gardée par le compacteur jusqu'ici, et dernier
+// bloc du code ; retourne le nombre d'octets écrits
+static size_t writeCodeEnd(CodeWriter* writer, FILE* output_file) {
+    unsigned char tail[BF_PACKED_MAX_TOKEN];
+    size_t tail_length;
+    switch (writer->payload) {
+        case ARCHIVE_PAYLOAD_PACKED:
+            tail_length = bfPackFinish(&writer->packer, tail);
+            fwrite(tail, 1, tail_length, output_file);
+            return tail_length;
+        case ARCHIVE_PAYLOAD_HUFFMAN:
+            tail_length = bfPackFinish(&writer->packer, tail);
+            return writeHuffman(output_file, writer->block, &writer->block_length, tail, tail_length, 1);
+        default:
+            return 0;
+    }
+}
+
+static void freeCodeWriter(CodeWriter* writer) {
+    free(writer->packed);
+    free(writer->block);
+    bfEncoderFree(&writer->encoder);
+}
+
+// Vrai si les données du morceau known, relues dans leur fichier d'origine,
+// sont celles de data : l'empreinte seule ne suffit pas à réutiliser un code
+static int sameChunk(const DedupChunk* known, const unsigned char* data, unsigned char* buffer) {
+    FILE* source = fopen(files[known->source].path, "rb");
+    if (!source) {
+        return 0;
+    }
+    int same = (fseeko(source, (off_t)known->source_offset, SEEK_SET) == 0 &&
+                fread(buffer, 1, (size_t)known->size, source) == known->size &&
+                memcmp(buffer, data, (size_t)known->size) == 0);
+    fclose(source);
+    return same;
+}
+
+// Code du fichier files[source] découpé en morceaux définis par leur contenu :
+// un morceau déjà vu (même empreinte, même taille, mêmes octets) devient une
+// référence à son code, les autres sont encodés chacun depuis une bande vierge.
+// data reçoit le fichier par fenêtres de DEDUP_WINDOW octets, suivies de la
+// place d'un morceau relu. Retourne -1 si l'encodage échoue.
+static int writeChunks(CodeWriter* writer, DedupIndex* chunks, FILE* output_file, FILE* input_file,
+                       size_t source, unsigned char* data, size_t* file_bytes, uint64_t* payload_length,
+                       size_t processed_bytes, size_t* reused_bytes) {
+    size_t filled = 0;
+    int end_of_file = 0;
+    for (;;) {
+        // Une coupure est cherchée sur DEDUP_MAX_CHUNK octets, sauf en fin de fichier
+        while (!end_of_file && filled < DEDUP_WINDOW) {
+            size_t bytesRead = fread(data + filled, 1, DEDUP_WINDOW - filled, input_file);
+            end_of_file = (bytesRead == 0);
+            filled += bytesRead;
+        }
+        if (filled == 0) {
+            return 0;
+        }
+
+        DedupChunk chunk;
+        chunk.size = dedupCut(data, filled);
+        dedupFingerprint(data, (size_t)chunk.size, chunk.hash);
+        const DedupChunk* known = dedupIndexFind(chunks, chunk.hash, chunk.size);
+        if (known && !sameChunk(known, data, data + DEDUP_WINDOW)) {
+            // Collision d'empreinte, ou fichier modifié depuis : le morceau est encodé
+            // et remplace l'ancien dans l'index
+            known = NULL;
+        }
+        off_t chunk_offset = ftello(output_file);
+        if (chunk_offset < 0) {
+            return -1;
+        }
+        if (known) {
+            ArchiveChunk record = {ARCHIVE_CHUNK_REFERENCE, (uint32_t)chunk.size, known->code_length, known->code_offset};
+            if (archiveWriteChunk(output_file, &record) != 0) {
+                return -1;
+            }
+            *payload_length += ARCHIVE_CHUNK_SIZE;
+            *reused_bytes += (size_t)chunk.size;
+        } else {
+            // Longueur du code corrigée une fois écrit
+            ArchiveChunk record = {ARCHIVE_CHUNK_CODE, (uint32_t)chunk.size, 0, 0};
+            if (archiveWriteChunk(output_file, &record) != 0) {
+                return -1;
+            }
+            resetCodeWriter(writer);
+            size_t written = writeCode(writer, output_file, data, (size_t)chunk.size);
+            if (written == (size_t)-1) {
+                return -1;
+            }
+            written += writeCodeEnd(writer, output_file);
+            chunk.code_offset = chunk_offset + ARCHIVE_CHUNK_SIZE;
+            chunk.code_length = written;
+            chunk.source = source;
+            chunk.source_offset = *file_bytes;
+            if (archivePatchChunk(output_file, chunk_offset, written) != 0 || dedupIndexAdd(chunks, &chunk) != 0) {
+                return -1;
+            }
+            *payload_length += ARCHIVE_CHUNK_SIZE + written;
+        }
+
+        *file_bytes += (size_t)chunk.size;
+        filled -= (size_t)chunk.size;
+        memmove(data, data + chunk.size, filled);
+        print_progress_bar(processed_bytes + *file_bytes, total_bytes);
+    }
+}
+
+// Fichiers ordonnés par taille, puis par identité (périphérique, inode) et par
+// position dans la liste : les liens physiques d'un même fichier se suivent
+static int compareIdentities(const void* a, const void* b) {
+    const FileInfo* x = &files[*(const size_t*)a];
+    const FileInfo* y = &files[*(const size_t*)b];
+    if (x->size != y->size) {
+        return (x->size > y->size) - (x->size < y->size);
+    }
+    if (x->device != y->device) {
+        return (x->device > y->device) - (x->device < y->device);
+    }
+    if (x->inode != y->inode) {
+        return (x->inode > y->inode) - (x->inode < y->inode);
+    }
+    return (*(const size_t*)a > *(const size_t*)b) - (*(const size_t*)a < *(const size_t*)b);
+}
+
+// Fichier de même taille qu'un autre, ordonné par empreinte de son contenu
+typedef struct {
+    size_t index;
+    uint64_t hash[2];
+} ContentCandidate;
+
+static int compareContents(const void* a, const void* b) {
+    const ContentCandidate* x = (const ContentCandidate*)a;
+    const ContentCandidate* y = (const ContentCandidate*)b;
+    for (int h = 0; h < 2; h++) {
+        if (x->hash[h] != y->hash[h]) {
+            return (x->hash[h] > y->hash[h]) - (x->hash[h] < y->hash[h]);
+        }
+    }
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static int hashFile(const char* path, unsigned char* buffer, uint64_t hash[2]) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    DedupHash state;
+    dedupHashInit(&state);
+    size_t bytesRead;
+    while ((bytesRead = fread(buffer, 1, CHUNK_SIZE, file)) > 0) {
+        dedupHashUpdate(&state, buffer, bytesRead);
+    }
+    int status = ferror(file) ? -1 : 0;
+    fclose(file);
+    dedupHashFinal(&state, hash);
+    return status;
+}
+
+// 1 si les deux fichiers ont le même contenu, octet par octet
+static int sameContent(const char* first, const char* second, unsigned char* buffer) {
+    FILE* a = fopen(first, "rb");
+    FILE* b = fopen(second, "rb");
+    int same = (a && b);
+    while (same) {
+        size_t length = fread(buffer, 1, CHUNK_SIZE, a);
+        same = (fread(buffer + CHUNK_SIZE, 1, CHUNK_SIZE, b) == length && !ferror(a) &&
+                memcmp(buffer, buffer + CHUNK_SIZE, length) == 0);
+        if (length == 0) {
+            break;
+        }
+    }
+    if (a) fclose(a);
+    if (b) fclose(b);
+    return same;
+}
+
+// Marque les doubles de fichiers qui les précèdent dans files : même
+// (périphérique, inode) sans rien lire, sinon même taille, même empreinte et
+// même contenu, vérifié octet par octet. Retourne le nombre de doubles.
+static size_t findDuplicates(size_t* duplicate_bytes) {
+    size_t* order = (size_t*)malloc((file_count ? file_count : 1) * sizeof(size_t));
+    ContentCandidate* candidates = (ContentCandidate*)malloc((file_count ? file_count : 1) * sizeof(ContentCandidate));
+    unsigned char* buffer = (unsigned char*)malloc(2 * CHUNK_SIZE);
+    size_t count = 0;
+    size_t duplicates = 0;
+    *duplicate_bytes = 0;
+    if (!order || !candidates || !buffer) {
+        free(order);
+        free(candidates);
+        free(buffer);
+        return 0;
+    }
+    for (size_t i = 0; i < file_count; i++) {
+        if (!files[i].is_directory && files[i].size > 0) {
+            order[count++] = i;
+        }
+    }
+    qsort(order, count, sizeof(size_t), compareIdentities);
+
+    for (size_t start = 0; start < count;) {
+        size_t size = files[order[start]].size;
+        size_t end = start;
+        size_t distinct = 0;
+        while (end < count && files[order[end]].size == size) {
+            // Liens physiques : doubles du premier lien de la liste
+            FileInfo* fi = &files[order[end]];
+            const FileInfo* previous = (end > start) ? &files[order[end - 1]] : NULL;
+            if (previous && fi->inode != 0 && fi->device == previous->device && fi->inode == previous->inode) {
+                fi->link = ARCHIVE_LINK_HARD;
+                fi->link_target = (previous->link == ARCHIVE_LINK_HARD) ? previous->link_target : order[end - 1];
+                duplicates++;
+                *duplicate_bytes += size;
+            } else {
+                candidates[distinct].index = order[end];
+                distinct++;
+            }
+            end++;
+        }
+
+        // Fichiers distincts de même taille : empreinte, puis comparaison des contenus égaux
+        if (distinct > 1) {
+            size_t hashed = 0;
+            for (size_t c = 0; c < distinct; c++) {
+                if (hashFile(files[candidates[c].index].path, buffer, candidates[c].hash) == 0) {
+                    candidates[hashed++] = candidates[c];
+                }
+            }
+            qsort(candidates, hashed, sizeof(ContentCandidate), compareContents);
+            // Chaque suite d'empreintes égales commence par le fichier le plus tôt dans la liste
+            size_t first = 0;
+            for (size_t c = 1; c < hashed; c++) {
+                if (memcmp(candidates[c - 1].hash, candidates[c].hash, sizeof(candidates[c].hash)) != 0) {
+                    first = c;
+                    continue;
+                }
+                FileInfo* fi = &files[candidates[c].index];
+                if (sameContent(files[candidates[first].index].path, fi->path, buffer)) {
+                    fi->link = ARCHIVE_LINK_COPY;
+                    fi->link_target = candidates[first].index;
+                    duplicates++;
+                    *duplicate_bytes += size;
+                }
+            }
+        }
+        start = end;
+    }
+    free(order);
+    free(candidates);
+    free(buffer);
+    return duplicates;
+}
+
+int compressFiles(const char* output_filename, const char** input_paths, int path_count, const CompressOptions* options) {
     clock_t start = clock();
     files = NULL;
     file_count = 0;
@@ -137,6 +532,9 @@ int compressFiles(const char* output_filename, const char** input_paths, int pat
             files[file_count].path = strdup(path);
             files[file_count].is_directory = 0;
             files[file_count].size = st.st_size;
+            files[file_count].device = st.st_dev;
+            files[file_count].inode = st.st_ino;
+            files[file_count].link = -1;
             total_bytes += st.st_size;
             file_count++;
         }
@@ -150,22 +548,92 @@ int compressFiles(const char* output_filename, const char** input_paths, int pat
         return -1;
     }
 
-    fprintf(output_file, "BrainZip Archive\n");
-    fprintf(output_file, "FileCount:%zu\n", file_count);
-    
-    // Écrire les métadonnées
-    for (size_t i = 0; i < file_count; i++) {
-        FileInfo* fi = &files[i];
-        fprintf(output_file, "Entry:%s;Type:%s;Size:%zu\n", 
-                fi->path, fi->is_directory ? "DIR" : "FILE", fi->size);
+    // Archive binaire : chaque entrée porte sa taille et celle de son code ;
+    // archive texte (version 1) : métadonnées en tête, code lu ligne à ligne
+    int binary = (options->format != 1);
+    if (binary) {
+        if (archiveWriteHeader(output_file, file_count, ARCHIVE_FLAG_TOC) != 0) {
+            fprintf(stderr, "Erreur d'écriture de l'archive %s\n", output_filename);
+            fclose(output_file);
+            return -1;
+        }
+    } else {
+        fprintf(output_file, "BrainZip Archive\n");
+        fprintf(output_file, "FileCount:%zu\n", file_count);
+
+        // Écrire les métadonnées
+        for (size_t i = 0; i < file_count; i++) {
+            FileInfo* fi = &files[i];
+            fprintf(output_file, "Entry:%s;Type:%s;Size:%zu\n",
+                    fi->path, fi->is_directory ? "DIR" : "FILE", fi->size);
+        }
+        fprintf(output_file, "EndMetadata\n");
     }
-    fprintf(output_file, "EndMetadata\n");
 
-    // Compression des fichiers
+    // Doubles de fichiers précédents (liens physiques, copies) : seul un lien
+    // vers le code de l'original sera écrit
+    size_t duplicate_bytes = 0;
+    size_t duplicates = binary ? findDuplicates(&duplicate_bytes) : 0;
+
+    // Compression des fichiers, par morceaux de CHUNK_SIZE octets (fenêtres de
+    // DEDUP_WINDOW octets avec déduplication, plus un morceau relu pour
+    // comparaison) : la mémoire utilisée ne dépend pas de la taille des fichiers
+    int dedup = binary && options->dedup;
+    int flags = dedup ? ARCHIVE_ENTRY_CHUNKED : 0;
     size_t processed_bytes = 0;
-    for (size_t i = 0; i < file_count; i++) {
+    size_t reused_bytes = 0;
+    unsigned char* data = (unsigned char*)malloc(dedup ? DEDUP_WINDOW + DEDUP_MAX_CHUNK : CHUNK_SIZE);
+    int payload = binary ? options->payload : ARCHIVE_PAYLOAD_BRAINFUCK;
+    CodeWriter writer;
+    if (!data || initCodeWriter(&writer, &options->encoding, payload) != 0) {
+        fprintf(stderr, "Erreur d'allocation mémoire\n");
+        free(data);
+        fclose(output_file);
+        return -1;
+    }
+    // Morceaux déjà écrits dans l'archive, retrouvés par leur empreinte
+    DedupIndex chunks;
+    dedupIndexInit(&chunks);
+
+    int result = 0;
+    for (size_t i = 0; i < file_count && result == 0; i++) {
         FileInfo* fi = &files[i];
+        ArchiveEntry entry = {fi->is_directory ? ARCHIVE_DIRECTORY : ARCHIVE_FILE, payload,
+                              fi->is_directory ? 0 : flags, (uint32_t)strlen(fi->path), fi->size, 0, 0};
+        // Position de l'entrée : son code suit l'en-tête et le chemin
+        off_t entry_offset = binary ? ftello(output_file) : 0;
+        fi->code_offset = entry_offset + ARCHIVE_ENTRY_SIZE + (off_t)entry.path_length;
+        fi->code_length = 0;
+        fi->encoding = payload;
+        fi->flags = entry.flags;
         if (fi->is_directory) {
+            if (binary && archiveWriteEntry(output_file, &entry, fi->path) != 0) {
+                fprintf(stderr, "\nErreur d'écriture de l'archive %s\n", output_filename);
+                result = -1;
+            }
+            continue;
+        }
+
+        if (fi->link >= 0) {
+            // L'original d'un lien physique peut lui-même être la copie d'un fichier antérieur
+            const FileInfo* original = &files[fi->link_target];
+            if (original->link >= 0) {
+                original = &files[original->link_target];
+            }
+            ArchiveLink link = {fi->link, original->flags, fi->link_target, original->code_length, original->code_offset};
+            entry.encoding = original->encoding;
+            entry.flags = ARCHIVE_ENTRY_LINK;
+            entry.payload_length = ARCHIVE_LINK_SIZE;
+            if (entry_offset < 0 || archiveWriteEntry(output_file, &entry, fi->path) != 0 ||
+                archiveWriteLink(output_file, &link) != 0) {
+                fprintf(stderr, "\nErreur d'écriture de l'archive %s\n", output_filename);
+                result = -1;
+                break;
+            }
+            fi->encoding = entry.encoding;
+            fi->flags = entry.flags;
+            fi->code_length = ARCHIVE_LINK_SIZE;
+            processed_bytes += fi->size;
             continue;
         }
 
@@ -177,49 +645,92 @@ int compressFiles(const char* output_filename, const char** input_paths, int pat
         FILE* input_file = fopen(full_path, "rb");
         if (!input_file) {
             fprintf(stderr, "\nErreur : Impossible d'ouvrir le fichier %s\n", full_path);
-            fclose(output_file);
-            return -1;
-        }
-
-        // Utiliser la taille déjà connue du fichier au lieu de ftell
-        size_t filesize = fi->size;
-        unsigned char* data = (unsigned char*)malloc(filesize);
-        if (!data) {
-            fprintf(stderr, "\nErreur d'allocation mémoire pour le fichier %s\n", full_path);
-            fclose(input_file);
-            fclose(output_file);
-            return -1;
+            result = -1;
+            break;
         }
 
-        size_t bytesRead = fread(data, 1, filesize, input_file);
-        fclose(input_file);
-        
-        if (bytesRead != filesize) {
-            fprintf(stderr, "\nErreur de lecture du fichier %s\n", full_path);
-            free(data);
-            fclose(output_file);
-            return -1;
+        // La longueur du code n'est connue qu'à la fin : elle est corrigée ensuite
+        if (binary) {
+            if (entry_offset < 0 || archiveWriteEntry(output_file, &entry, fi->path) != 0) {
+                fprintf(stderr, "\nErreur d'écriture de l'archive %s\n", output_filename);
+                fclose(input_file);
+                result = -1;
+                break;
+            }
+        } else {
+            fprintf(output_file, "StartFile:%s\n", fi->path);
         }
 
-        char* bf_code = toBrainfuck(data, filesize);
-        free(data);
+        size_t file_bytes = 0;
+        if (dedup) {
+            result = writeChunks(&writer, &chunks, output_file, input_file, i, data, &file_bytes,
+                                 &entry.payload_length, processed_bytes, &reused_bytes);
+        } else {
+            // Chaque fichier repart d'une bande vierge
+            resetCodeWriter(&writer);
+            size_t bytesRead;
+            while (result == 0 && (bytesRead = fread(data, 1, CHUNK_SIZE, input_file)) > 0) {
+                size_t written = writeCode(&writer, output_file, data, bytesRead);
+                if (written == (size_t)-1) {
+                    result = -1;
+                    break;
+                }
+                entry.payload_length += written;
 
-        if (!bf_code) {
+                file_bytes += bytesRead;
+                print_progress_bar(processed_bytes + file_bytes, total_bytes);
+            }
+            entry.payload_length += writeCodeEnd(&writer, output_file);
+        }
+        fclose(input_file);
+        if (result != 0) {
             fprintf(stderr, "\nErreur lors de la conversion en Brainfuck du fichier %s\n", full_path);
-            fclose(output_file);
-            return -1;
+            break;
         }
 
-        fprintf(output_file, "StartFile:%s\n", fi->path);
-        fprintf(output_file, "%s\n", bf_code);
-        fprintf(output_file, "EndFile\n");
+        // Utiliser la taille déjà connue du fichier pour vérifier la lecture
+        if (file_bytes != fi->size) {
+            fprintf(stderr, "\nErreur de lecture du fichier %s\n", full_path);
+            result = -1;
+            break;
+        }
 
-        free(bf_code);
-        processed_bytes += filesize;
+        if (!binary) {
+            fprintf(output_file, "\nEndFile\n");
+        } else if (archivePatchPayload(output_file, entry_offset, entry.payload_length) != 0) {
+            fprintf(stderr, "\nErreur d'écriture de l'archive %s\n", output_filename);
+            result = -1;
+            break;
+        }
+        fi->code_length = entry.payload_length;
+        processed_bytes += fi->size;
     }
     
+    free(data);
+    freeCodeWriter(&writer);
+    size_t unique_chunks = chunks.count;
+    dedupIndexFree(&chunks);
+
+    // Table des matières en fin d'archive : chaque entrée est retrouvée par son chemin
+    if (result == 0 && binary && writeToc(output_file) != 0) {
+        fprintf(stderr, "\nErreur d'écriture de l'archive %s\n", output_filename);
+        result = -1;
+    }
+    if (result != 0) {
+        fclose(output_file);
+        return -1;
+    }
+
     print_progress_bar(total_bytes, total_bytes);
     printf("\nCompression terminée!\n");
+    if (duplicates > 0) {
+        printf("Doublons : %zu fichiers (%zu octets) enregistrés comme liens vers leur original\n",
+               duplicates, duplicate_bytes);
+    }
+    if (dedup) {
+        printf("Déduplication : %zu octets repris de morceaux identiques, %zu morceaux encodés\n",
+               reused_bytes, unique_chunks);
+    }
 
     fclose(output_file);
 
@@ -292,88 +803,755 @@ size_t calculate_total_brainfuck_size(FILE* file) {
     return total_size;
 }
 
-int decompressFile(const char* input_filename) {
-    clock_t start = clock();
-    FILE* input_file = fopen(input_filename, "rb");
-    if (!input_file) {
-        fprintf(stderr, "Erreur : Impossible d'ouvrir le fichier %s\n", input_filename);
+// Fonction d'écriture du décodeur : la sortie va directement dans le fichier
+static int writeDecoded(void* context, const unsigned char* data, size_t length) {
+    return (fwrite(data, 1, length, (FILE*)context) == length) ? BF_OK : BF_ERROR_WRITE;
+}
+
+// Fichier extrait écrit au fil du décodage, faute de projection : les octets
+// écrits sont comptés pour les comparer à la taille enregistrée, et refusés
+// dès qu'ils la dépasseraient
+typedef struct {
+    FILE* file;
+    uint64_t length;
+    uint64_t size;
+    int exceeded;
+} OutputFile;
+
+static int writeOutput(void* context, const unsigned char* data, size_t length) {
+    OutputFile* output = (OutputFile*)context;
+    if (length > output->size - output->length) {
+        output->exceeded = 1;
+        return BF_ERROR_OUTPUT_SIZE;
+    }
+    output->length += length;
+    return writeDecoded(output->file, data, length);
+}
+
+// Destination du code d'une entrée, selon son encodage
+typedef struct {
+    BfDecoder* decoder;
+    int encoding;
+    HuffmanReader huffman;  // Blocs décodés avant le code compacté (ARCHIVE_PAYLOAD_HUFFMAN)
+} CodeSink;
+
+static int feedPackedBlock(void* context, const unsigned char* data, size_t length) {
+    return bfDecoderFeedPacked((BfDecoder*)context, data, length);
+}
+
+static int initCodeSink(CodeSink* sink, BfDecoder* decoder, int encoding) {
+    sink->decoder = decoder;
+    sink->encoding = encoding;
+    sink->huffman.pending = NULL;
+    sink->huffman.block = NULL;
+    if (encoding == ARCHIVE_PAYLOAD_HUFFMAN) {
+        return huffmanReaderInit(&sink->huffman);
+    }
+    return BF_OK;
+}
+
+// Donne un morceau de code au décodeur
+static int feedCode(CodeSink* sink, const char* code, size_t length) {
+    switch (sink->encoding) {
+        case ARCHIVE_PAYLOAD_PACKED:
+            return bfDecoderFeedPacked(sink->decoder, (const unsigned char*)code, length);
+        case ARCHIVE_PAYLOAD_HUFFMAN:
+            return huffmanReaderFeed(&sink->huffman, (const unsigned char*)code, length,
+                                     feedPackedBlock, sink->decoder);
+        default:
+            return bfDecoderFeed(sink->decoder, code, length);
+    }
+}
+
+static int finishCode(CodeSink* sink) {
+    int status = BF_OK;
+    if (sink->encoding == ARCHIVE_PAYLOAD_HUFFMAN) {
+        status = huffmanReaderFinish(&sink->huffman);
+    }
+    return (status == BF_OK) ? bfDecoderFinish(sink->decoder) : status;
+}
+
+// Code suivant indépendant, dont la sortie prolonge celle du précédent
+static void restartCode(CodeSink* sink) {
+    bfDecoderRestart(sink->decoder);
+    huffmanReaderReset(&sink->huffman);
+}
+
+static void freeCodeSink(CodeSink* sink) {
+    huffmanReaderFree(&sink->huffman);
+}
+
+#ifdef MAP_OUTPUT
+// Donne au fichier extrait sa taille finale et le projette en mémoire ;
+// NULL si le système refuse, l'écriture au fil du décodage prend alors le relais
+static unsigned char* mapOutput(FILE* file, size_t size) {
+    int fd = fileno(file);
+    if (posix_fallocate(fd, 0, (off_t)size) != 0 && ftruncate(fd, (off_t)size) != 0) {
+        return NULL;
+    }
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        ftruncate(fd, 0);
+        return NULL;
+    }
+    return (unsigned char*)data;
+}
+
+// Archive projetée en lecture : le code est donné au décodeur sans copie ;
+// data reste NULL si impossible, la lecture par fread prend alors le relais
+static void mapArchive(FILE* file, MappedArchive* archive) {
+    struct stat st;
+    archive->data = NULL;
+    archive->size = 0;
+    archive->released = 0;
+    if (fstat(fileno(file), &st) != 0 || st.st_size <= 0 || (unsigned long long)st.st_size > SIZE_MAX) {
+        return;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (data == MAP_FAILED) {
+        return;
+    }
+    // Lecture anticipée agressive : chaque code est parcouru du début à la fin
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    archive->data = (const char*)data;
+    archive->size = (size_t)st.st_size;
+}
+
+// Rend au système les pages de l'archive lues avant position, avec une tranche
+// de retard : un défaut de page projette aussi les pages voisines, y compris
+// celles d'une tranche qui vient d'être rendue
+static void releaseArchive(MappedArchive* archive, size_t position) {
+    if (position < archive->released + 2 * MAP_SLICE) {
+        return;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = archive->released & ~(page - 1);
+    size_t end = (position - MAP_SLICE) & ~(page - 1);
+    madvise((void*)(archive->data + start), end - start, MADV_DONTNEED);
+    archive->released = end;
+}
+
+// Donne au décodeur les length octets de code projetés à offset, par tranches
+// de MAP_SLICE : le noyau lit la tranche suivante pendant le décodage de la
+// courante, et les pages déjà décodées sont rendues
+static int feedMapped(CodeSink* sink, MappedArchive* archive, size_t offset, size_t length,
+                      size_t* processed, size_t total) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    int status = BF_OK;
+    size_t done = 0;
+    while (status == BF_OK && done < length) {
+        size_t slice = (length - done < MAP_SLICE) ? length - done : MAP_SLICE;
+        if (done + slice < length) {
+            size_t next = (offset + done + slice) & ~(page - 1);
+            size_t ahead = (archive->size - next < MAP_SLICE) ? archive->size - next : MAP_SLICE;
+            madvise((void*)(archive->data + next), ahead, MADV_WILLNEED);
+        }
+        status = feedCode(sink, archive->data + offset + done, slice);
+        done += slice;
+        releaseArchive(archive, offset + done);
+        *processed += slice;
+        print_progress_bar(*processed, total);
+    }
+    return status;
+}
+
+// Longueur du code d'une entrée commençant à offset dans l'archive projetée,
+// jusqu'au saut de ligne qui précède "EndFile" ; (size_t)-1 sans ligne EndFile
+static size_t entryCodeLength(const MappedArchive* archive, size_t offset) {
+    const char* code = archive->data + offset;
+    size_t remaining = archive->size - offset;
+    const char* line = code;
+    while (line) {
+        size_t left = remaining - (size_t)(line - code);
+        if (left >= 8 && memcmp(line, "EndFile\n", 8) == 0) {
+            return (line == code) ? 0 : (size_t)(line - code) - 1;
+        }
+        line = (const char*)memchr(line, '\n', left);
+        if (line) {
+            line++;
+        }
+    }
+    return (size_t)-1;
+}
+
+static void unmapFile(const void* data, size_t size) {
+    if (data) {
+        munmap((void*)data, size);
+    }
+}
+#else
+static void releaseArchive(MappedArchive* archive, size_t position) {
+    (void)archive;
+    (void)position;
+}
+
+static int feedMapped(CodeSink* sink, MappedArchive* archive, size_t offset, size_t length,
+                      size_t* processed, size_t total) {
+    (void)sink;
+    (void)archive;
+    (void)offset;
+    (void)length;
+    (void)processed;
+    (void)total;
+    return BF_ERROR_UNSUPPORTED;
+}
+
+static size_t entryCodeLength(const MappedArchive* archive, size_t offset) {
+    (void)archive;
+    (void)offset;
+    return (size_t)-1;
+}
+
+static void unmapFile(const void* data, size_t size) {
+    (void)data;
+    (void)size;
+}
+#endif
+
+// Lit length octets de l'archive à offset, dans la projection quand elle existe
+static int readArchive(FILE* input_file, const MappedArchive* archive, off_t offset,
+                       unsigned char* data, size_t length) {
+    if (archive->data) {
+        if ((uint64_t)offset > archive->size || length > archive->size - (size_t)offset) {
+            return -1;
+        }
+        memcpy(data, archive->data + offset, length);
+        return 0;
+    }
+    return (fseeko(input_file, offset, SEEK_SET) == 0 && fread(data, 1, length, input_file) == length) ? 0 : -1;
+}
+
+// Donne au décodeur les length octets de code à offset, projetés ou lus par
+// morceaux dans buffer ; BF_ERROR_CORRUPT si l'archive s'arrête avant
+static int feedRange(CodeSink* sink, FILE* input_file, MappedArchive* archive, off_t offset, size_t length,
+                     char* buffer, size_t* processed, size_t total) {
+    if (archive->data) {
+        if ((uint64_t)offset > archive->size || length > archive->size - (size_t)offset) {
+            return BF_ERROR_CORRUPT;
+        }
+        return feedMapped(sink, archive, (size_t)offset, length, processed, total);
+    }
+    if (fseeko(input_file, offset, SEEK_SET) != 0) {
+        return BF_ERROR_CORRUPT;
+    }
+    int status = BF_OK;
+    while (status == BF_OK && length > 0) {
+        size_t piece = (length < CHUNK_SIZE) ? length : CHUNK_SIZE;
+        if (fread(buffer, 1, piece, input_file) != piece) {
+            return BF_ERROR_CORRUPT;
+        }
+        status = feedCode(sink, buffer, piece);
+        length -= piece;
+        *processed += piece;
+        print_progress_bar(*processed, total);
+    }
+    return status;
+}
+
+// Enregistrement de morceau à position, dans le code d'une entrée qui finit à
+// end ; chunk->code_offset devient la place de son code, qui suit
+// l'enregistrement ou, pour une référence, se trouve plus tôt dans l'archive.
+// -1 si incohérent.
+static int readChunk(FILE* input_file, const MappedArchive* archive, off_t position, off_t end,
+                     ArchiveChunk* chunk) {
+    unsigned char data[ARCHIVE_CHUNK_SIZE];
+    if (end - position < ARCHIVE_CHUNK_SIZE ||
+        readArchive(input_file, archive, position, data, sizeof(data)) != 0 ||
+        archiveParseChunk(data, chunk) != 0 || chunk->code_length > SIZE_MAX) {
         return -1;
     }
+    if (chunk->kind == ARCHIVE_CHUNK_CODE) {
+        chunk->code_offset = position + ARCHIVE_CHUNK_SIZE;
+        return (chunk->code_length <= (uint64_t)(end - chunk->code_offset)) ? 0 : -1;
+    }
+    // Seul un code écrit avant l'enregistrement peut être repris : une
+    // référence ne mène jamais hors de l'archive ni vers elle-même
+    if (chunk->code_offset < ARCHIVE_HEADER_SIZE || chunk->code_offset > position ||
+        chunk->code_length > (uint64_t)(position - chunk->code_offset)) {
+        return -1;
+    }
+    return 0;
+}
+
+// Position de l'enregistrement qui suit chunk, lu à position
+static off_t nextChunk(const ArchiveChunk* chunk, off_t position) {
+    position += ARCHIVE_CHUNK_SIZE;
+    return (chunk->kind == ARCHIVE_CHUNK_CODE) ? position + (off_t)chunk->code_length : position;
+}
+
+// Code d'une entrée ARCHIVE_ENTRY_CHUNKED : chaque morceau est décodé depuis
+// une bande vierge et sa sortie prolonge celle du précédent. La progression ne
+// compte que le code de l'entrée, pas celui des morceaux repris.
+static int feedChunks(CodeSink* sink, FILE* input_file, const FileInfo* fi, MappedArchive* archive,
+                      char* buffer, size_t* processed, size_t total) {
+    const BfOutput* output = &sink->decoder->machine.output;
+    off_t position = fi->code_offset;
+    off_t end = fi->code_offset + (off_t)fi->code_length;
+    uint64_t produced = 0;
+    int status = BF_OK;
+    while (status == BF_OK && position < end) {
+        ArchiveChunk chunk;
+        if (readChunk(input_file, archive, position, end, &chunk) != 0) {
+            return BF_ERROR_CORRUPT;
+        }
+        produced += chunk.size;
+        if (produced > fi->size) {
+            return BF_ERROR_OUTPUT_SIZE;
+        }
+        *processed += ARCHIVE_CHUNK_SIZE;
+        size_t referenced = *processed;
+        status = feedRange(sink, input_file, archive, chunk.code_offset, (size_t)chunk.code_length, buffer,
+                           (chunk.kind == ARCHIVE_CHUNK_CODE) ? processed : &referenced, total);
+        if (status == BF_OK) {
+            status = finishCode(sink);
+        }
+        // Sortie fixe : chaque morceau doit produire exactement sa taille
+        if (status == BF_OK && output->fixed && output->length != produced) {
+            status = BF_ERROR_OUTPUT_SIZE;
+        }
+        restartCode(sink);
+        position = nextChunk(&chunk, position);
+    }
+    if (status == BF_OK && produced != fi->size) {
+        status = BF_ERROR_OUTPUT_SIZE;
+    }
+    return status;
+}
+
+static void freeEntries(FileInfo* entries, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+}
 
+// Métadonnées d'une archive texte (version 1), lues jusqu'à "EndMetadata"
+static FileInfo* readTextIndex(FILE* input_file, size_t* count, size_t* total_size) {
     char line[BUFFER_SIZE];
     size_t entry_count = 0;
-    size_t total_processed = 0;
 
     if (!fgets(line, BUFFER_SIZE, input_file) || strcmp(line, "BrainZip Archive\n") != 0) {
         fprintf(stderr, "Erreur : Fichier d'archive invalide\n");
-        fclose(input_file);
-        return -1;
+        return NULL;
     }
 
     if (fgets(line, BUFFER_SIZE, input_file) && sscanf(line, "FileCount:%zu", &entry_count) != 1) {
         fprintf(stderr, "Erreur : Nombre d'entrées invalide\n");
-        fclose(input_file);
-        return -1;
+        return NULL;
     }
 
-    printf("Archive contenant %zu entrées\n", entry_count);
-    
-    FileInfo* entries = (FileInfo*)malloc(entry_count * sizeof(FileInfo));
+    FileInfo* entries = (FileInfo*)malloc((entry_count ? entry_count : 1) * sizeof(FileInfo));
     if (!entries) {
         fprintf(stderr, "Erreur d'allocation mémoire\n");
-        fclose(input_file);
-        return -1;
+        return NULL;
     }
 
     // Lire les métadonnées
-    size_t total_size = 0;
+    *total_size = 0;
     for (size_t i = 0; i < entry_count; i++) {
         if (!fgets(line, BUFFER_SIZE, input_file)) {
             fprintf(stderr, "Erreur : Lecture des métadonnées échouée\n");
-            fclose(input_file);
-            return -1;
+            freeEntries(entries, i);
+            return NULL;
         }
 
         char path[BUFFER_SIZE];
         char type[10];
         size_t file_size = 0;
-        
+
         // Format mis à jour pour inclure la taille
         if (sscanf(line, "Entry:%[^;];Type:%[^;];Size:%zu", path, type, &file_size) != 3) {
             // Fallback pour la compatibilité avec l'ancien format
-            if (sscanf(line, "Entry:%[^;];Type:%s", path, type) != 2) {
+            if (sscanf(line, "Entry:%[^;];Type:%9s", path, type) != 2) {
                 fprintf(stderr, "Erreur : Métadonnées de l'entrée invalide\n");
-                fclose(input_file);
-                return -1;
+                freeEntries(entries, i);
+                return NULL;
             }
         }
-        
+
         entries[i].path = strdup(path);
         entries[i].is_directory = (strcmp(type, "DIR") == 0) ? 1 : 0;
         entries[i].size = file_size;
-        
+        entries[i].code_offset = -1;
+        entries[i].code_length = (size_t)-1;
+        entries[i].encoding = ARCHIVE_PAYLOAD_BRAINFUCK;
+        entries[i].flags = 0;
+        entries[i].link = -1;
+        entries[i].link_target = (size_t)-1;
+
         if (!entries[i].is_directory) {
-            total_size += file_size;
+            *total_size += file_size;
         }
     }
 
     if (!fgets(line, BUFFER_SIZE, input_file) || strcmp(line, "EndMetadata\n") != 0) {
         fprintf(stderr, "Erreur : Fin des métadonnées non trouvée\n");
+        freeEntries(entries, entry_count);
+        return NULL;
+    }
+
+    *count = entry_count;
+    return entries;
+}
+
+// Remplace le lien d'un double (ARCHIVE_ENTRY_LINK) par le code de l'original ;
+// -1 si le lien est incohérent
+static int followLink(FILE* input_file, const ArchiveEntry* entry, FileInfo* fi) {
+    ArchiveLink link;
+    if (entry->type != ARCHIVE_FILE || archiveReadLink(input_file, entry, &link) != 0 ||
+        link.code_length > SIZE_MAX || link.target > SIZE_MAX) {
+        return -1;
+    }
+    fi->code_offset = link.code_offset;
+    fi->code_length = (size_t)link.code_length;
+    fi->flags = link.flags;
+    fi->link = link.kind;
+    fi->link_target = (size_t)link.target;
+    return 0;
+}
+
+// Entrées d'une archive binaire : seuls les en-têtes et les chemins sont lus,
+// le code de chaque entrée est sauté d'un seul déplacement
+static FileInfo* readBinaryIndex(FILE* input_file, size_t* count, size_t* total_size, size_t* total_code) {
+    ArchiveHeader header;
+    if (archiveReadHeader(input_file, &header) != 0) {
+        fprintf(stderr, "Erreur : Fichier d'archive invalide\n");
+        return NULL;
+    }
+    if (header.version != ARCHIVE_VERSION) {
+        fprintf(stderr, "Erreur : Version d'archive non prise en charge (%d)\n", header.version);
+        return NULL;
+    }
+
+    off_t archive_size;
+    if (fseeko(input_file, 0, SEEK_END) != 0 || (archive_size = ftello(input_file)) < 0 ||
+        fseeko(input_file, ARCHIVE_HEADER_SIZE, SEEK_SET) != 0) {
+        fprintf(stderr, "Erreur : Lecture de l'archive échouée\n");
+        return NULL;
+    }
+    // Chaque entrée occupe au moins un en-tête : un nombre plus grand est corrompu
+    if (header.entry_count > (uint64_t)(archive_size - ARCHIVE_HEADER_SIZE) / ARCHIVE_ENTRY_SIZE) {
+        fprintf(stderr, "Erreur : Nombre d'entrées invalide\n");
+        return NULL;
+    }
+
+    size_t entry_count = (size_t)header.entry_count;
+    FileInfo* entries = (FileInfo*)malloc((entry_count ? entry_count : 1) * sizeof(FileInfo));
+    if (!entries) {
+        fprintf(stderr, "Erreur d'allocation mémoire\n");
+        return NULL;
+    }
+
+    *total_size = 0;
+    *total_code = 0;
+    for (size_t i = 0; i < entry_count; i++) {
+        ArchiveEntry entry;
+        char* path;
+        if (archiveReadEntry(input_file, archive_size, &entry, &path) != 0 || entry.payload_length > SIZE_MAX) {
+            fprintf(stderr, "Erreur : Métadonnées de l'entrée %zu invalides\n", i);
+            freeEntries(entries, i);
+            return NULL;
+        }
+        if (entry.encoding > ARCHIVE_PAYLOAD_HUFFMAN) {
+            fprintf(stderr, "Erreur : Encodage %d non pris en charge pour %s\n", entry.encoding, path);
+            free(path);
+            freeEntries(entries, i);
+            return NULL;
+        }
+
+        entries[i].path = path;
+        entries[i].is_directory = (entry.type == ARCHIVE_DIRECTORY);
+        entries[i].size = (size_t)entry.size;
+        entries[i].code_offset = entry.payload_offset;
+        entries[i].code_length = (size_t)entry.payload_length;
+        entries[i].encoding = entry.encoding;
+        entries[i].flags = entry.flags;
+        entries[i].link = -1;
+        entries[i].link_target = (size_t)-1;
+        // Un double renvoie à un fichier de même taille qui le précède
+        if ((entry.flags & ARCHIVE_ENTRY_LINK) &&
+            (followLink(input_file, &entry, &entries[i]) != 0 || entries[i].link_target >= i ||
+             entries[entries[i].link_target].is_directory || entries[entries[i].link_target].size != entries[i].size)) {
+            fprintf(stderr, "Erreur : Lien de l'entrée %zu invalide\n", i);
+            freeEntries(entries, i + 1);
+            return NULL;
+        }
+        // Le code d'un double n'est lu que si l'original manque
+        if (!entries[i].is_directory) {
+            *total_size += entries[i].size;
+            *total_code += (entries[i].link < 0) ? entries[i].code_length : 0;
+        }
+
+        if (fseeko(input_file, entry.payload_offset + (off_t)entry.payload_length, SEEK_SET) != 0) {
+            fprintf(stderr, "Erreur : Lecture de l'archive échouée\n");
+            freeEntries(entries, i + 1);
+            return NULL;
+        }
+    }
+
+    *count = entry_count;
+    return entries;
+}
+
+// Crée le dossier parent de path si nécessaire
+static void createParentDirectory(const char* path) {
+    char* dir_path = strdup(path);
+    char* last_slash = strrchr(dir_path, '/');
+    if (last_slash) {
+        *last_slash = '\0';
+        create_directory(dir_path);
+    }
+    free(dir_path);
+}
+
+// Recopie les size octets du fichier source dans destination
+static int copyFile(const char* source, const char* destination, size_t size, char* buffer) {
+    FILE* input_file = fopen(source, "rb");
+    if (!input_file) {
+        return -1;
+    }
+    FILE* output_file = fopen(destination, "wb");
+    if (!output_file) {
         fclose(input_file);
         return -1;
     }
+    size_t copied = 0;
+    size_t bytesRead;
+    int status = 0;
+    while (status == 0 && (bytesRead = fread(buffer, 1, CHUNK_SIZE, input_file)) > 0) {
+        if (fwrite(buffer, 1, bytesRead, output_file) != bytesRead) {
+            status = -1;
+        }
+        copied += bytesRead;
+    }
+    fclose(input_file);
+    if (fclose(output_file) != 0 || copied != size) {
+        status = -1;
+    }
+    return status;
+}
+
+// Recrée un double à partir de l'original déjà extrait : lien physique s'ils
+// partageaient un inode à la compression, copie sinon ou si le lien échoue.
+// -1 si impossible : le code de l'original est alors décodé.
+static int restoreDuplicate(const FileInfo* fi, const FileInfo* original, char* buffer) {
+    if (strcmp(fi->path, original->path) == 0) {
+        return -1;
+    }
+    createParentDirectory(fi->path);
+    if (fi->link == ARCHIVE_LINK_HARD) {
+        remove(fi->path);
+        if (LINK(original->path, fi->path) == 0) {
+            return 0;
+        }
+    }
+    return copyFile(original->path, fi->path, fi->size, buffer);
+}
+
+// Extrait une entrée de fichier. Archive binaire : le code occupe code_length
+// octets à code_offset, lus dans archive quand elle est projetée, sinon par
+// morceaux dans buffer (CHUNK_SIZE octets) ; archive texte : il est lu ligne
+// à ligne à partir de la position courante jusqu'à "EndFile".
+static int extractEntry(BfDecoder* decoder, FILE* input_file, const FileInfo* fi,
+                        MappedArchive* archive, char* buffer,
+                        const DecompressOptions* options, size_t* processed, size_t total) {
+    int text = (fi->code_length == (size_t)-1);
 
+    // Double décodé faute d'original extrait : son code n'entre pas dans la progression
+    size_t skipped;
+    if (fi->link >= 0) {
+        skipped = *processed;
+        processed = &skipped;
+    }
+
+    createParentDirectory(fi->path);
+
+    CodeSink sink;
+    if (initCodeSink(&sink, decoder, fi->encoding) != BF_OK) {
+        fprintf(stderr, "\nErreur d'allocation mémoire pour le décodeur\n");
+        return -1;
+    }
+
+    // Le fichier extrait est écrit au fil du décodage, ou projeté : une
+    // projection partagée en écriture demande aussi l'accès en lecture
+    FILE* output_file = fopen(fi->path, "w+b");
+    if (!output_file) {
+        fprintf(stderr, "\nErreur : Impossible de créer le fichier %s\n", fi->path);
+        freeCodeSink(&sink);
+        return -1;
+    }
+
+    // Taille connue : le décodeur écrit directement dans le fichier projeté.
+    // Sous une fenêtre de sortie, un seul fwrite coûte moins que la projection.
+    unsigned char* destination = NULL;
+#ifdef MAP_OUTPUT
+    if (fi->size >= BF_DECODER_WINDOW) {
+        destination = mapOutput(output_file, fi->size);
+    }
+#endif
+    OutputFile output = {output_file, 0, fi->size, 0};
+    if (destination) {
+        bfDecoderResetInto(decoder, destination, fi->size);
+    } else {
+        bfDecoderReset(decoder, &output);
+    }
+    int status = BF_OK;
+    size_t output_length = fi->size;
+
+    // Grande entrée : tout son code est décodé d'un coup, sur plusieurs fils,
+    // en place dans l'archive projetée (code en texte ou compacté, d'un seul tenant)
+    off_t code_offset = fi->code_offset;
+    size_t code_length = fi->code_length;
+    int chunked = (fi->flags & ARCHIVE_ENTRY_CHUNKED) != 0;
+    int parallel = (archive->data && destination && fi->size >= PARALLEL_MIN_SIZE && options->threads > 1
+                    && fi->encoding != ARCHIVE_PAYLOAD_HUFFMAN && !chunked);
+    if (parallel && text) {
+        code_offset = ftello(input_file);
+        code_length = (code_offset >= 0) ? entryCodeLength(archive, (size_t)code_offset) : (size_t)-1;
+        parallel = (code_length != (size_t)-1);
+    }
+
+    if (parallel) {
+        if (fi->encoding == ARCHIVE_PAYLOAD_PACKED) {
+            status = fromPackedParallel((const unsigned char*)archive->data + code_offset, code_length, destination,
+                                        fi->size, &output_length, &options->decoding, options->threads);
+        } else {
+            status = fromBrainfuckParallel(archive->data + code_offset, code_length, destination, fi->size,
+                                           &output_length, &options->decoding, options->threads);
+        }
+        if (text) {
+            fseeko(input_file, code_offset + (off_t)code_length + (code_length > 0 ? 9 : 8), SEEK_SET);
+        }
+        releaseArchive(archive, (size_t)code_offset + code_length);
+        *processed += code_length + (size_t)text;
+        print_progress_bar(*processed, total);
+    } else if (chunked) {
+        status = feedChunks(&sink, input_file, fi, archive, buffer, processed, total);
+        output_length = decoder->machine.output.length;
+    } else if (archive->data && !text) {
+        // Longueur connue : le décodeur lit le code directement dans l'archive projetée
+        status = feedMapped(&sink, archive, (size_t)code_offset, code_length, processed, total);
+        if (status == BF_OK) {
+            status = finishCode(&sink);
+        }
+        output_length = decoder->machine.output.length;
+    } else if (!text) {
+        // Longueur du code connue : lecture par morceaux, sans chercher de fin de ligne
+        size_t remaining = fi->code_length;
+        if (fseeko(input_file, fi->code_offset, SEEK_SET) != 0) {
+            remaining = 1;
+        }
+        while (status == BF_OK && remaining > 0) {
+            size_t piece = (remaining < CHUNK_SIZE) ? remaining : CHUNK_SIZE;
+            if (fread(buffer, 1, piece, input_file) != piece) {
+                break;
+            }
+            status = feedCode(&sink, buffer, piece);
+            remaining -= piece;
+            *processed += piece;
+            print_progress_bar(*processed, total);
+        }
+
+        if (status == BF_OK && remaining > 0) {
+            fprintf(stderr, "\nErreur : Code tronqué pour %s\n", fi->path);
+            unmapFile(destination, fi->size);
+            fclose(output_file);
+            freeCodeSink(&sink);
+            return -1;
+        }
+
+        if (status == BF_OK) {
+            status = finishCode(&sink);
+        }
+        output_length = decoder->machine.output.length;
+    } else {
+        // Chaque ligne lue est décodée aussitôt : seule la fenêtre de sortie
+        // et les boucles encore ouvertes restent en mémoire
+        while (status == BF_OK && fgets(buffer, CHUNK_SIZE, input_file) && strcmp(buffer, "EndFile\n") != 0) {
+            size_t line_length = strlen(buffer);
+            status = bfDecoderFeed(decoder, buffer, line_length);
+
+            // Mise à jour de la barre de progression
+            *processed += line_length;
+            print_progress_bar(*processed, total);
+        }
+
+        if (status == BF_OK && feof(input_file)) {
+            fprintf(stderr, "\nErreur : EndFile non trouvé pour %s\n", fi->path);
+            unmapFile(destination, fi->size);
+            fclose(output_file);
+            freeCodeSink(&sink);
+            return -1;
+        }
+
+        if (status == BF_OK) {
+            status = bfDecoderFinish(decoder);
+        }
+        output_length = decoder->machine.output.length;
+    }
+    // Taille enregistrée dans l'archive ; un code plus long s'est arrêté dès le dépassement
+    if (!destination) {
+        output_length = (size_t)output.length;
+        if (output.exceeded) {
+            status = BF_ERROR_OUTPUT_SIZE;
+        }
+    }
+    if (status == BF_OK && output_length != fi->size) {
+        status = BF_ERROR_OUTPUT_SIZE;
+    }
+    unmapFile(destination, fi->size);
+    freeCodeSink(&sink);
+    if (fclose(output_file) != 0 && status == BF_OK) {
+        status = BF_ERROR_WRITE;
+    }
+
+    if (status != BF_OK) {
+        fprintf(stderr, "\nErreur lors de l'interprétation du code Brainfuck pour %s : %s\n",
+                fi->path, bfErrorMessage(status));
+        return -1;
+    }
+    return 0;
+}
+
+int decompressFile(const char* input_filename, const DecompressOptions* options) {
+    clock_t start = clock();
+    FILE* input_file = fopen(input_filename, "rb");
+    if (!input_file) {
+        fprintf(stderr, "Erreur : Impossible d'ouvrir le fichier %s\n", input_filename);
+        return -1;
+    }
+
+    // Le format est reconnu à sa signature ; sinon archive texte (version 1)
+    char magic[ARCHIVE_MAGIC_SIZE];
+    int binary = (fread(magic, 1, sizeof(magic), input_file) == sizeof(magic) &&
+                  memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE) == 0);
+    rewind(input_file);
+
+    size_t entry_count = 0;
+    size_t total_size = 0;
+    size_t total_code = 0;
+    FileInfo* entries = binary ? readBinaryIndex(input_file, &entry_count, &total_size, &total_code)
+                               : readTextIndex(input_file, &entry_count, &total_size);
+    if (!entries) {
+        fclose(input_file);
+        return -1;
+    }
+
+    printf("Archive contenant %zu entrées\n", entry_count);
     printf("Taille totale des données: %zu octets\n", total_size);
-    
-    // Si la taille totale n'est pas disponible dans les métadonnées
-    if (total_size == 0) {
+
+    // Progression mesurée sur le code lu ; une archive texte n'en donne pas la
+    // longueur, la taille des données en tient lieu
+    size_t progress_total = binary ? total_code : total_size;
+    if (!binary && total_size == 0) {
+        char line[BUFFER_SIZE];
         printf("Calcul de la taille des données...\n");
-        total_size = calculate_total_brainfuck_size(input_file);
+        progress_total = total_size = calculate_total_brainfuck_size(input_file);
         // Retourner après EndMetadata
         fseek(input_file, 0, SEEK_SET);
         while (fgets(line, BUFFER_SIZE, input_file) && strcmp(line, "EndMetadata\n") != 0);
     }
-    
+
     printf("Création des dossiers...\n");
     // Créer d'abord tous les dossiers
     for (size_t i = 0; i < entry_count; i++) {
@@ -384,123 +1562,401 @@ int decompressFile(const char* input_filename) {
     }
 
     printf("Décompression des fichiers...\n");
-    
+
+    // Un seul décodeur pour toutes les entrées : tampons et bande sont réutilisés
+    BfDecoder decoder;
+    char* buffer = (char*)malloc(CHUNK_SIZE);
+    if (!buffer || bfDecoderInit(&decoder, &options->decoding, writeOutput, NULL) != BF_OK) {
+        fprintf(stderr, "Erreur d'allocation mémoire pour le décodeur\n");
+        free(buffer);
+        freeEntries(entries, entry_count);
+        fclose(input_file);
+        return -1;
+    }
+
+    // Archive projetée : le code est lu sans copie, et décodé sur plusieurs fils pour les grandes entrées
+    MappedArchive archive = {NULL, 0, 0};
+#ifdef MAP_OUTPUT
+    mapArchive(input_file, &archive);
+#endif
+
     // Ensuite extraire les fichiers
-    for (size_t i = 0; i < entry_count; i++) {
+    size_t total_processed = 0;
+    int result = 0;
+    for (size_t i = 0; i < entry_count && result == 0; i++) {
         FileInfo* fi = &entries[i];
         if (fi->is_directory) {
             continue;
         }
 
-        // Rechercher le début du fichier
-        while (fgets(line, BUFFER_SIZE, input_file) && strncmp(line, "StartFile:", 10) != 0);
+        if (!binary) {
+            // Rechercher le début du fichier
+            while (fgets(buffer, CHUNK_SIZE, input_file) && strncmp(buffer, "StartFile:", 10) != 0);
 
-        if (feof(input_file)) {
-            fprintf(stderr, "\nErreur : StartFile non trouvé pour %s\n", fi->path);
-            fclose(input_file);
-            return -1;
+            if (feof(input_file)) {
+                fprintf(stderr, "\nErreur : StartFile non trouvé pour %s\n", fi->path);
+                result = -1;
+                break;
+            }
+
+            buffer[strcspn(buffer, "\n")] = '\0';
+            if (strcmp(buffer + 10, fi->path) != 0) {
+                fprintf(stderr, "\nErreur : Nom de fichier non correspondant (%s vs %s)\n", buffer + 10, fi->path);
+                result = -1;
+                break;
+            }
         }
 
-        char start_filename[BUFFER_SIZE];
-        sscanf(line, "StartFile:%[^\n]", start_filename);
+        if (fi->link_target < i && restoreDuplicate(fi, &entries[fi->link_target], buffer) == 0) {
+            continue;
+        }
+        result = extractEntry(&decoder, input_file, fi, &archive, buffer,
+                              options, &total_processed, progress_total);
+    }
+
+    unmapFile(archive.data, archive.size);
+    bfDecoderFree(&decoder);
+    free(buffer);
+    fclose(input_file);
+    freeEntries(entries, entry_count);
+    if (result != 0) {
+        return -1;
+    }
+
+    print_progress_bar(progress_total, progress_total);
+    printf("\nDécompression terminée!\n");
+
+    clock_t end = clock();
+    double elapsed = (double)(end - start) / CLOCKS_PER_SEC;
+    printf("Temps total: %.2f secondes\n", elapsed);
+    
+    if (total_size > 0) {
+        printf("Vitesse moyenne: %.2f MiB/s\n", (total_size / (1024.0 * 1024.0)) / elapsed);
+    }
+
+    return 0;
+}
 
-        if (strcmp(start_filename, fi->path) != 0) {
-            fprintf(stderr, "\nErreur : Nom de fichier non correspondant (%s vs %s)\n", start_filename, fi->path);
-            fclose(input_file);
+// Entrée path d'une archive binaire : par la table des matières quand elle
+// existe, sinon parmi les entrées lues une à une (index)
+static int findEntry(FILE* input_file, const ArchiveToc* toc, const FileInfo* index, size_t index_count,
+                     const char* path, FileInfo* fi) {
+    if (!index) {
+        ArchiveEntry entry;
+        int found = archiveLookup(input_file, toc, path, &entry);
+        if (found != 1) {
+            return found;
+        }
+        if (entry.encoding > ARCHIVE_PAYLOAD_HUFFMAN || entry.payload_length > SIZE_MAX) {
             return -1;
         }
-
-        // Lire le code Brainfuck
-        char* bf_code = NULL;
-        size_t bf_code_size = 0;
-        size_t bf_code_capacity = BUFFER_SIZE * 4;  // Plus grand buffer initial
-        bf_code = (char*)malloc(bf_code_capacity * sizeof(char));
-        if (!bf_code) {
-            fprintf(stderr, "\nErreur d'allocation mémoire pour le code Brainfuck\n");
-            fclose(input_file);
+        fi->is_directory = (entry.type == ARCHIVE_DIRECTORY);
+        fi->size = (size_t)entry.size;
+        fi->code_offset = entry.payload_offset;
+        fi->code_length = (size_t)entry.payload_length;
+        fi->encoding = entry.encoding;
+        fi->flags = entry.flags;
+        fi->link = -1;
+        if ((entry.flags & ARCHIVE_ENTRY_LINK) && followLink(input_file, &entry, fi) != 0) {
             return -1;
         }
-        bf_code[0] = '\0';
-
-        while (fgets(line, BUFFER_SIZE, input_file) && strcmp(line, "EndFile\n") != 0) {
-            size_t line_length = strlen(line);
-            if (bf_code_size + line_length >= bf_code_capacity) {
-                bf_code_capacity *= 2;
-                char* temp = (char*)realloc(bf_code, bf_code_capacity * sizeof(char));
-                if (!temp) {
-                    fprintf(stderr, "\nErreur de réallocation mémoire pour le code Brainfuck\n");
-                    free(bf_code);
-                    fclose(input_file);
-                    return -1;
-                }
-                bf_code = temp;
-            }
-            strcat(bf_code, line);
-            bf_code_size += line_length;
-            
-            // Mise à jour de la barre de progression
-            total_processed += line_length;
-            print_progress_bar(total_processed, total_size);
+    } else {
+        size_t i = 0;
+        while (i < index_count && strcmp(index[i].path, path) != 0) {
+            i++;
         }
-
-        if (feof(input_file)) {
-            fprintf(stderr, "\nErreur : EndFile non trouvé pour %s\n", fi->path);
-            free(bf_code);
-            fclose(input_file);
-            return -1;
+        if (i == index_count) {
+            return 0;
         }
+        *fi = index[i];
+    }
+    // L'original n'est pas forcément parmi les entrées choisies : le double est décodé
+    fi->link_target = (size_t)-1;
+    fi->path = strdup(path);
+    return fi->path ? 1 : -1;
+}
 
-        // Interpréter le code Brainfuck
-        size_t output_length = 0;
-        unsigned char* data = fromBrainfuck(bf_code, &output_length);
-        free(bf_code);
+// Entrées nommées d'une archive binaire, toutes si path_count vaut 0. Les
+// absentes sont signalées ensemble et *result passe à -1 ; NULL si l'archive
+// n'est pas lisible.
+static FileInfo* selectEntries(FILE* input_file, const char* input_filename, const char** paths, int path_count,
+                               size_t* selected_count, size_t* total_size, size_t* total_code, int* result) {
+    // Seule une archive binaire donne la position du code de chaque entrée
+    ArchiveHeader header;
+    off_t archive_size = -1;
+    if (archiveReadHeader(input_file, &header) != 0 || header.version != ARCHIVE_VERSION ||
+        fseeko(input_file, 0, SEEK_END) != 0 || (archive_size = ftello(input_file)) < 0) {
+        fprintf(stderr, "Erreur : %s n'est pas une archive binaire, utilisez decompress\n", input_filename);
+        return NULL;
+    }
 
-        if (!data) {
-            fprintf(stderr, "\nErreur lors de l'interprétation du code Brainfuck pour %s\n", fi->path);
-            fclose(input_file);
-            return -1;
+    ArchiveToc toc;
+    FileInfo* index = NULL;
+    size_t index_count = 0;
+    if (path_count == 0 || archiveReadToc(input_file, archive_size, &header, &toc) != 0) {
+        rewind(input_file);
+        index = readBinaryIndex(input_file, &index_count, total_size, total_code);
+        if (!index) {
+            return NULL;
         }
+        if (path_count == 0) {
+            *selected_count = index_count;
+            return index;
+        }
+    }
 
-        // Créer le dossier parent si nécessaire
-        char* dir_path = strdup(fi->path);
-        char* last_slash = strrchr(dir_path, '/');
-        if (last_slash) {
-            *last_slash = '\0';
-            create_directory(dir_path);
+    FileInfo* selected = (FileInfo*)malloc((size_t)path_count * sizeof(FileInfo));
+    if (!selected) {
+        fprintf(stderr, "Erreur d'allocation mémoire\n");
+        if (index) {
+            freeEntries(index, index_count);
         }
-        free(dir_path);
+        return NULL;
+    }
 
-        // Écrire le fichier extrait
-        FILE* output_file = fopen(fi->path, "wb");
-        if (!output_file) {
-            fprintf(stderr, "\nErreur : Impossible de créer le fichier %s\n", fi->path);
-            free(data);
-            fclose(input_file);
-            return -1;
+    *selected_count = 0;
+    *total_size = 0;
+    *total_code = 0;
+    for (int i = 0; i < path_count; i++) {
+        FileInfo* fi = &selected[*selected_count];
+        int found = findEntry(input_file, &toc, index, index_count, paths[i], fi);
+        if (found < 0) {
+            fprintf(stderr, "Erreur : Table des matières invalide pour %s\n", paths[i]);
+            *result = -1;
+            break;
         }
+        if (found == 0) {
+            fprintf(stderr, "Erreur : %s absent de l'archive\n", paths[i]);
+            *result = -1;
+            continue;
+        }
+        if (!fi->is_directory) {
+            *total_size += fi->size;
+            *total_code += (fi->link < 0) ? fi->code_length : 0;
+        }
+        (*selected_count)++;
+    }
+    if (index) {
+        freeEntries(index, index_count);
+    }
+    return selected;
+}
 
-        fwrite(data, 1, output_length, output_file);
-        fclose(output_file);
-        free(data);
+int extractFiles(const char* input_filename, const char** paths, int path_count, const DecompressOptions* options) {
+    clock_t start = clock();
+    FILE* input_file = fopen(input_filename, "rb");
+    if (!input_file) {
+        fprintf(stderr, "Erreur : Impossible d'ouvrir le fichier %s\n", input_filename);
+        return -1;
     }
 
-    print_progress_bar(total_size, total_size);
-    printf("\nDécompression terminée!\n");
-    
-    fclose(input_file);
+    // Toutes les entrées sont cherchées avant d'extraire : les absentes sont signalées
+    // ensemble, les autres extraites quand même
+    int result = 0;
+    size_t selected_count = 0;
+    size_t total_size = 0;
+    size_t total_code = 0;
+    FileInfo* selected = selectEntries(input_file, input_filename, paths, path_count,
+                                       &selected_count, &total_size, &total_code, &result);
+    if (!selected) {
+        fclose(input_file);
+        return -1;
+    }
 
-    for (size_t i = 0; i < entry_count; i++) {
-        free(entries[i].path);
+    BfDecoder decoder;
+    char* buffer = (char*)malloc(CHUNK_SIZE);
+    if (!buffer || bfDecoderInit(&decoder, &options->decoding, writeOutput, NULL) != BF_OK) {
+        fprintf(stderr, "Erreur d'allocation mémoire pour le décodeur\n");
+        free(buffer);
+        freeEntries(selected, selected_count);
+        fclose(input_file);
+        return -1;
     }
-    free(entries);
-    
+
+    MappedArchive archive = {NULL, 0, 0};
+#ifdef MAP_OUTPUT
+    mapArchive(input_file, &archive);
+#endif
+
+    // Entrées réellement restaurées, seules comptées dans le bilan
+    size_t total_processed = 0;
+    size_t restored_count = 0;
+    size_t restored_size = 0;
+    int failed = 0;
+    for (size_t i = 0; i < selected_count; i++) {
+        FileInfo* fi = &selected[i];
+        if (fi->is_directory) {
+            create_directory(fi->path);
+        } else if (!(fi->link_target < i && restoreDuplicate(fi, &selected[fi->link_target], buffer) == 0) &&
+                   extractEntry(&decoder, input_file, fi, &archive, buffer,
+                                options, &total_processed, total_code) != 0) {
+            failed = 1;
+            break;
+        }
+        restored_count++;
+        restored_size += fi->is_directory ? 0 : fi->size;
+    }
+
+    unmapFile(archive.data, archive.size);
+    bfDecoderFree(&decoder);
+    free(buffer);
+    fclose(input_file);
+    freeEntries(selected, selected_count);
+    if (selected_count > 0) {
+        printf("\n");
+    }
+    // Comme pour decompress, pas de bilan après une entrée qui n'a pu être extraite
+    if (failed) {
+        return -1;
+    }
+
     clock_t end = clock();
     double elapsed = (double)(end - start) / CLOCKS_PER_SEC;
-    printf("Temps total: %.2f secondes\n", elapsed);
-    
-    if (total_size > 0) {
-        printf("Vitesse moyenne: %.2f MiB/s\n", (total_size / (1024.0 * 1024.0)) / elapsed);
+    printf("%zu entrées extraites (%zu octets) en %.3f secondes\n", restored_count, restored_size, elapsed);
+    return result;
+}
+
+// Texte d'un code compacté, écrit dans file au fil de sa lecture
+typedef struct {
+    BfPackedReader reader;
+    FILE* file;
+} TextExport;
+
+static int unpackBlock(void* context, const unsigned char* data, size_t length) {
+    TextExport* text = (TextExport*)context;
+    return bfUnpack(&text->reader, data, length, writeDecoded, text->file);
+}
+
+// Écrit en texte, dans name, les length octets de code de fi à offset : un
+// code compacté est redéroulé, un code en texte recopié tel quel
+static int exportCode(FILE* input_file, const FileInfo* fi, off_t offset, size_t length,
+                      const char* name, char* buffer) {
+    createParentDirectory(name);
+    FILE* output_file = fopen(name, "wb");
+    if (!output_file) {
+        fprintf(stderr, "Erreur : Impossible de créer le fichier %s\n", name);
+        return -1;
+    }
+
+    TextExport text;
+    bfUnpackInit(&text.reader);
+    text.file = output_file;
+    HuffmanReader huffman = {NULL, 0, NULL};
+    int status = BF_OK;
+    if (fi->encoding == ARCHIVE_PAYLOAD_HUFFMAN) {
+        status = huffmanReaderInit(&huffman);
+    }
+    size_t remaining = length;
+    int readable = (fseeko(input_file, offset, SEEK_SET) == 0);
+    while (readable && status == BF_OK && remaining > 0) {
+        size_t piece = (remaining < CHUNK_SIZE) ? remaining : CHUNK_SIZE;
+        if (fread(buffer, 1, piece, input_file) != piece) {
+            break;
+        }
+        if (fi->encoding == ARCHIVE_PAYLOAD_HUFFMAN) {
+            status = huffmanReaderFeed(&huffman, (const unsigned char*)buffer, piece, unpackBlock, &text);
+        } else if (fi->encoding == ARCHIVE_PAYLOAD_PACKED) {
+            status = unpackBlock(&text, (const unsigned char*)buffer, piece);
+        } else {
+            status = writeDecoded(output_file, (const unsigned char*)buffer, piece);
+        }
+        remaining -= piece;
+    }
+    if (status == BF_OK && fi->encoding == ARCHIVE_PAYLOAD_HUFFMAN) {
+        status = huffmanReaderFinish(&huffman);
+    }
+    if (status == BF_OK) {
+        status = bfUnpackFinish(&text.reader);
+    }
+    huffmanReaderFree(&huffman);
+    if (fclose(output_file) != 0 && status == BF_OK) {
+        status = BF_ERROR_WRITE;
     }
 
+    if (status == BF_OK && remaining > 0) {
+        fprintf(stderr, "Erreur : Code tronqué pour %s\n", fi->path);
+        return -1;
+    } else if (status != BF_OK) {
+        fprintf(stderr, "Erreur lors de l'export du code de %s : %s\n", fi->path, bfErrorMessage(status));
+        return -1;
+    }
     return 0;
 }
+
+// Écrit le code d'une entrée dans <chemin>.bf. Une entrée découpée en morceaux
+// n'a pas de code d'un seul tenant : chaque morceau, programme complet dont la
+// sortie prolonge celle du précédent, va dans <chemin>.<n>.bf.
+static int exportEntry(FILE* input_file, const FileInfo* fi, char* buffer) {
+    size_t name_length = strlen(fi->path) + 32;
+    char* name = (char*)malloc(name_length);
+    if (!name) {
+        fprintf(stderr, "Erreur d'allocation mémoire\n");
+        return -1;
+    }
+
+    int result = 0;
+    if (!(fi->flags & ARCHIVE_ENTRY_CHUNKED)) {
+        snprintf(name, name_length, "%s.bf", fi->path);
+        result = exportCode(input_file, fi, fi->code_offset, fi->code_length, name, buffer);
+    } else {
+        MappedArchive unmapped = {NULL, 0, 0};
+        off_t position = fi->code_offset;
+        off_t end = fi->code_offset + (off_t)fi->code_length;
+        for (size_t number = 0; result == 0 && position < end; number++) {
+            ArchiveChunk chunk;
+            if (readChunk(input_file, &unmapped, position, end, &chunk) != 0) {
+                fprintf(stderr, "Erreur : Morceau %zu invalide pour %s\n", number, fi->path);
+                result = -1;
+                break;
+            }
+            snprintf(name, name_length, "%s.%zu.bf", fi->path, number);
+            result = exportCode(input_file, fi, chunk.code_offset, (size_t)chunk.code_length, name, buffer);
+            position = nextChunk(&chunk, position);
+        }
+    }
+    free(name);
+    return result;
+}
+
+int exportBrainfuck(const char* input_filename, const char** paths, int path_count) {
+    FILE* input_file = fopen(input_filename, "rb");
+    if (!input_file) {
+        fprintf(stderr, "Erreur : Impossible d'ouvrir le fichier %s\n", input_filename);
+        return -1;
+    }
+
+    int result = 0;
+    size_t selected_count = 0;
+    size_t total_size = 0;
+    size_t total_code = 0;
+    FileInfo* selected = selectEntries(input_file, input_filename, paths, path_count,
+                                       &selected_count, &total_size, &total_code, &result);
+    char* buffer = (char*)malloc(CHUNK_SIZE);
+    if (!selected || !buffer) {
+        if (selected) {
+            fprintf(stderr, "Erreur d'allocation mémoire\n");
+            freeEntries(selected, selected_count);
+        }
+        free(buffer);
+        fclose(input_file);
+        return -1;
+    }
+
+    size_t exported = 0;
+    for (size_t i = 0; i < selected_count; i++) {
+        if (selected[i].is_directory) {
+            continue;
+        }
+        if (exportEntry(input_file, &selected[i], buffer) != 0) {
+            result = -1;
+            break;
+        }
+        exported++;
+    }
+
+    free(buffer);
+    fclose(input_file);
+    freeEntries(selected, selected_count);
+    printf("%zu codes exportés\n", exported);
+    return result;
+}
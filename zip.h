@@ -1,7 +1,28 @@
 #ifndef ZIP_H
 #define ZIP_H
 
-int compressFiles(const char* output_filename, const char** input_files, int file_count);
-int decompressFile(const char* input_filename);
+#include "brainfuck.h"
+#include "archive.h"
+
+// Options de compression
+typedef struct {
+    BfEncodeOptions encoding;  // Algorithme d'encodage Brainfuck et ses paramètres
+    int format;                // Version du format d'archive : 1 (texte) ou ARCHIVE_VERSION (binaire)
+    int payload;               // Encodage du code en archive binaire (ARCHIVE_PAYLOAD_*)
+    int dedup;                 // Morceaux identiques écrits une seule fois (archive binaire)
+} CompressOptions;
+
+// Options de décompression
+typedef struct {
+    BfDecodeOptions decoding;  // Moteur d'exécution du code Brainfuck
+    int threads;               // Fils de décodage d'une grande entrée (1 : séquentiel)
+} DecompressOptions;
+
+int compressFiles(const char* output_filename, const char** input_files, int file_count, const CompressOptions* options);
+int decompressFile(const char* input_filename, const DecompressOptions* options);
+// Extrait seulement les entrées nommées, en allant directement à leur code
+int extractFiles(const char* input_filename, const char** paths, int path_count, const DecompressOptions* options);
+// Écrit le code Brainfuck en texte des entrées nommées (toutes sans chemin) dans <chemin>.bf
+int exportBrainfuck(const char* input_filename, const char** paths, int path_count);
 
 #endif //ZIP_H